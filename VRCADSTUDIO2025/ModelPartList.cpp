@@ -10,6 +10,15 @@
 #include "ModelPartList.h"
 #include "ModelPart.h"
 
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
+#include <functional>
+
+/* Number of children handed to the view by each call to fetchMore() */
+static const int FetchBatchSize = 1000;
+
 ModelPartList::ModelPartList( const QString& data, QObject* parent ) : QAbstractItemModel(parent) {
     /* Have option to specify number of visible properties for each item in tree - the root item
      * acts as the column headers
@@ -109,7 +118,39 @@ int ModelPartList::rowCount( const QModelIndex& parent ) const {
     else
         parentItem = static_cast<ModelPart*>(parent.internalPointer());
 
-    return parentItem->childCount();
+    return parentItem->fetchedChildCount();
+}
+
+
+bool ModelPartList::hasChildren( const QModelIndex& parent ) const {
+    if( parent.column() > 0 )
+        return false;
+
+    ModelPart* parentItem = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : rootItem;
+    return parentItem->childCount() > 0;
+}
+
+
+bool ModelPartList::canFetchMore( const QModelIndex& parent ) const {
+    if( parent.column() > 0 )
+        return false;
+
+    ModelPart* parentItem = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : rootItem;
+    return parentItem->fetchedChildCount() < parentItem->childCount();
+}
+
+
+void ModelPartList::fetchMore( const QModelIndex& parent ) {
+    ModelPart* parentItem = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : rootItem;
+
+    int fetched = parentItem->fetchedChildCount();
+    int count = std::min( FetchBatchSize, parentItem->childCount() - fetched );
+    if( count <= 0 )
+        return;
+
+    beginInsertRows( parent, fetched, fetched + count - 1 );
+    parentItem->setFetchedChildCount( fetched + count );
+    endInsertRows();
 }
 
 
@@ -124,35 +165,118 @@ QModelIndex ModelPartList::appendChild(QModelIndex& parent, const QList<QVariant
 
     if (parent.isValid())
         parentPart = static_cast<ModelPart*>(parent.internalPointer());
-    else {
+    else
         parentPart = rootItem;
-        parent = createIndex(0, 0, rootItem );
+
+    ModelPart* childPart = new ModelPart( data, parentPart );
+    int row = parentPart->childCount();
+
+    /* Only tell the view about the new row if it has already fetched all the others,
+     * otherwise it turns up with the next fetchMore() */
+    if (parentPart->fetchedChildCount() == row) {
+        beginInsertRows( parent, row, row );
+        parentPart->appendChild(childPart);
+        parentPart->setFetchedChildCount(row + 1);
+        endInsertRows();
+    }
+    else {
+        parentPart->appendChild(childPart);
     }
 
-    beginInsertRows( parent, rowCount(parent), rowCount(parent) ); 
+    return createIndex(row, 0, childPart);
+}
 
-    ModelPart* childPart = new ModelPart( data, parentPart );
 
-    parentPart->appendChild(childPart);
+QList<QModelIndex> ModelPartList::appendChildren(const QModelIndex& parent, const QList<QList<QVariant>>& data) {
+    QList<QModelIndex> children;
+    if (data.isEmpty())
+        return children;
 
-    QModelIndex child = createIndex(0, 0, childPart);
+    ModelPart* parentPart = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : rootItem;
+    int first = parentPart->childCount();
+    bool notify = parentPart->fetchedChildCount() == first;
 
-    endInsertRows();
+    /* One insert notification for the whole batch; if the view has rows still to
+     * fetch, the new ones simply turn up in later fetchMore() calls */
+    if (notify)
+        beginInsertRows(parent, first, first + data.size() - 1);
 
-    emit layoutChanged();
+    children.reserve(data.size());
+    for (const QList<QVariant>& itemData : data) {
+        ModelPart* childPart = new ModelPart(itemData, parentPart);
+        parentPart->appendChild(childPart);
+        children.append(createIndex(childPart->row(), 0, childPart));
+    }
 
-    return child;
+    if (notify) {
+        parentPart->setFetchedChildCount(parentPart->childCount());
+        endInsertRows();
+    }
+    return children;
 }
 
 bool ModelPartList::removeRow(int row, const QModelIndex &parent) {
-    if (row < 0 || row >= rowCount(parent)) return false;
+    return removeRows(row, 1, parent);
+}
 
-    beginRemoveRows(parent, row, row);
 
+bool ModelPartList::removeRows(int row, int count, const QModelIndex& parent) {
     ModelPart *parentPart = parent.isValid() ? static_cast<ModelPart*>(parent.internalPointer()) : rootItem;
-    ModelPart *childPart = parentPart->child(row);
-    parentPart->removeChild(childPart);  // Remove and delete the child
+    if (row < 0 || count <= 0 || row + count > parentPart->childCount()) return false;
+
+    /* Rows the view has not fetched yet are removed without telling it */
+    int fetched = parentPart->fetchedChildCount();
+    int lastVisible = std::min(row + count, fetched) - 1;
 
-    endRemoveRows();
+    if (lastVisible >= row)
+        beginRemoveRows(parent, row, lastVisible);
+
+    parentPart->removeChildren(row, count);  // Remove and delete the children, keeping the fetched count in step
+
+    if (lastVisible >= row)
+        endRemoveRows();
     return true;
+}
+
+
+int ModelPartList::removeItems(const QList<QPersistentModelIndex>& indexes) {
+    /* Group rows by parent, skipping items whose ancestor is also being removed */
+    QHash<ModelPart*, QList<int>> rowsByParent;
+    QSet<ModelPart*> removing;
+    for (const QPersistentModelIndex& index : indexes) {
+        if (index.isValid())
+            removing.insert(static_cast<ModelPart*>(index.internalPointer()));
+    }
+
+    for (ModelPart* part : removing) {
+        bool ancestorRemoved = false;
+        for (ModelPart* p = part->parentItem(); p && !ancestorRemoved; p = p->parentItem())
+            ancestorRemoved = removing.contains(p);
+        if (!ancestorRemoved)
+            rowsByParent[part->parentItem()].append(part->row());
+    }
+
+    int removed = 0;
+    for (auto it = rowsByParent.begin(); it != rowsByParent.end(); ++it) {
+        ModelPart* parentPart = it.key();
+        QModelIndex parent = parentPart == rootItem ? QModelIndex() : createIndex(parentPart->row(), 0, parentPart);
+
+        /* Remove from the bottom up so earlier rows keep their numbers */
+        QList<int> rows = it.value();
+        std::sort(rows.begin(), rows.end(), std::greater<int>());
+
+        int i = 0;
+        while (i < rows.size()) {
+            int last = rows[i];
+            int first = last;
+            while (i + 1 < rows.size() && rows[i + 1] == first - 1) {
+                first--;
+                i++;
+            }
+            removeRows(first, last - first + 1, parent);
+            removed += last - first + 1;
+            i++;
+        }
+    }
+    return removed;
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include <QVariant>
 #include <QString>
 #include <QList>
+#include <QPersistentModelIndex>
 
 class ModelPart;
 
@@ -81,11 +82,31 @@ public:
     QModelIndex parent( const QModelIndex& index ) const;
 
     /** Get number of rows (items) under an item in tree
+      *  Only children already handed to the view by fetchMore() are counted.
       *  @param is the parent, all items under this will be counted
       *  @return number of children
       */
     int rowCount( const QModelIndex& parent ) const;
 
+    /** Report whether an item has children, including ones not fetched yet, so the
+      *  view still shows an expand arrow for it
+      *  @param parent is the item to check
+      *  @return true if the item has any children
+      */
+    bool hasChildren( const QModelIndex& parent = QModelIndex() ) const;
+
+    /** Check whether an item has children the view has not been told about yet
+      *  @param parent is the item to check
+      *  @return true if fetchMore() would add rows
+      */
+    bool canFetchMore( const QModelIndex& parent ) const;
+
+    /** Hand the next batch of an item's children to the view. Large assemblies are
+      *  populated a batch at a time as the user expands and scrolls.
+      *  @param parent is the item to fetch children for
+      */
+    void fetchMore( const QModelIndex& parent );
+
     /** Get a pointer to the root item of the tree
       * @return the root item pointer
       */
@@ -94,10 +115,33 @@ public:
     /**
       */
     QModelIndex appendChild( QModelIndex& parent, const QList<QVariant>& data );
+
+    /** Append many items under one parent in a single model transaction, so the view
+      *  updates once however many items are added
+      * @param parent is the item to append under, or an invalid index for the root
+      * @param data holds the column data of each new item
+      * @return the indexes of the new items, in order
+      */
+    QList<QModelIndex> appendChildren( const QModelIndex& parent, const QList<QList<QVariant>>& data );
 	/**
       */
 	bool removeRow(int row, const QModelIndex &parent = QModelIndex());
 
+    /** Remove a run of consecutive items under one parent in a single model transaction
+      * @param row is the first item to remove
+      * @param count is the number of items to remove
+      * @param parent is the parent of the items
+      * @return true if the items were removed
+      */
+    bool removeRows( int row, int count, const QModelIndex& parent = QModelIndex() ) override;
+
+    /** Remove any set of items, grouping them into one removeRows() call per run of
+      *  consecutive rows. Children of removed items are ignored.
+      * @param indexes are the items to remove
+      * @return the number of items removed
+      */
+    int removeItems( const QList<QPersistentModelIndex>& indexes );
+
 private:
     ModelPart *rootItem;    /**< This is a pointer to the item at the base of the tree */
 };
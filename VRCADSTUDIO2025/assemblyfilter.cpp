@@ -0,0 +1,66 @@
+#include "assemblyfilter.h"
+#include "profiler.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <functional>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Applies a settings change to every part in a subtree, collecting the ones with geometry.
+     */
+    void collectParts(ModelPart* part, const std::function<void(ModelPart*)>& configure, std::vector<ModelPart*>& withGeometry) {
+        configure(part);
+        if (part->getOriginalPolyData())
+            withGeometry.push_back(part);
+
+        for (int i = 0; i < part->childCount(); ++i)
+            collectParts(part->child(i), configure, withGeometry);
+    }
+
+    /**
+     * @brief Runs the filters of each part on a thread pool, then commits all results on this thread.
+     */
+    int filterParts(ModelPart* root, const std::function<void(ModelPart*)>& configure) {
+        PROFILE_SCOPE("filterParts");
+
+        std::vector<ModelPart*> parts;
+        collectParts(root, configure, parts);
+
+        // Building the cell structure mutates the data set, so do it here rather than
+        // racing to do it on the workers
+        for (ModelPart* part : parts)
+            part->prepareFilterInput();
+
+        std::vector<vtkSmartPointer<vtkPolyData>> results(parts.size());
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(QThread::idealThreadCount());
+        for (size_t i = 0; i < parts.size(); ++i) {
+            ModelPart* part = parts[i];
+            pool.start([part, &results, i]() {
+                results[i] = part->runFilters();
+            });
+        }
+        pool.waitForDone();
+
+        for (size_t i = 0; i < parts.size(); ++i)
+            parts[i]->setFilteredData(results[i]);
+
+        return static_cast<int>(parts.size());
+    }
+}
+
+int ApplyClipFilterToSubtree(ModelPart* root, bool enable, double origin[3], double normal[3]) {
+    return filterParts(root, [enable, origin, normal](ModelPart* part) {
+        part->applyClipFilter(enable, origin, normal, false);
+    });
+}
+
+int ApplyShrinkFilterToSubtree(ModelPart* root, bool enable, double factor) {
+    return filterParts(root, [enable, factor](ModelPart* part) {
+        part->applyShrinkFilter(enable, factor, false);
+    });
+}
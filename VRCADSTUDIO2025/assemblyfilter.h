@@ -0,0 +1,36 @@
+#pragma once
+
+#include "ModelPart.h"
+
+/**
+ * @file
+ * This file contains functions that apply the clip and shrink filters to every
+ * part below a node of the model tree at once.
+ */
+
+/**
+ * @brief Enables or disables the clip filter on a part and all of its descendants.
+ *
+ * The parts are filtered concurrently on a thread pool, and the clip itself is
+ * vtkSMP-parallel within each part. The results are handed to the mappers together
+ * once every part is done, so the caller only needs to render once.
+ *
+ * @param root The top of the subtree.
+ * @param enable Whether to enable the filter.
+ * @param origin Origin point of the clipping plane.
+ * @param normal Normal vector of the clipping plane.
+ * @return The number of parts with geometry that were filtered.
+ */
+int ApplyClipFilterToSubtree(ModelPart* root, bool enable, double origin[3], double normal[3]);
+
+/**
+ * @brief Enables or disables the shrink filter on a part and all of its descendants.
+ *
+ * Works like ApplyClipFilterToSubtree().
+ *
+ * @param root The top of the subtree.
+ * @param enable Whether to enable shrinking.
+ * @param factor Shrink factor to apply.
+ * @return The number of parts with geometry that were filtered.
+ */
+int ApplyShrinkFilterToSubtree(ModelPart* root, bool enable, double factor);
@@ -0,0 +1,325 @@
+// vrcad_bench.cpp
+//
+// Benchmarks for loading, filtering, scene updates, tree model lookups and offscreen
+// frame time. Results are written as JSON with
+//   vrcad_bench --benchmark_out=results.json --benchmark_out_format=json
+
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "scenesync.h"
+#include "geometrycache.h"
+#include "geometryinstances.h"
+#include "stlgenerator.h"
+
+#include <benchmark/benchmark.h>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkActor.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkCamera.h>
+
+namespace {
+    /**
+     * @brief Returns a generated binary STL with the given number of triangles,
+     * writing it on first use.
+     */
+    QString syntheticSTL(int triangles) {
+        const QString fileName = QDir::temp().filePath(QString("vrcad_bench/synthetic_%1.stl").arg(triangles));
+        if (QFileInfo::exists(fileName))
+            return fileName;
+        QDir().mkpath(QFileInfo(fileName).path());
+
+        const QString partial = fileName + ".part";
+        if (!WriteSyntheticSTL(partial.toStdString(), triangles, 1, STLFormat::Binary)
+            || !QFile::rename(partial, fileName))
+            return QString();
+        return fileName;
+    }
+
+    /**
+     * @brief A model tree with one module holding the given number of parts that all
+     * share one small geometry.
+     */
+    struct Assembly {
+        std::unique_ptr<ModelPartList> list;
+        ModelPart* module = nullptr;
+
+        explicit Assembly(int parts) {
+            list = std::make_unique<ModelPartList>("PartsList");
+            module = new ModelPart({ "Module", "true" });
+            list->getRootItem()->appendChild(module);
+
+            const QString fileName = syntheticSTL(200);
+            vtkSmartPointer<vtkPolyData> data = ModelPart::readSTL(fileName);
+            for (int i = 0; i < parts; ++i) {
+                ModelPart* part = new ModelPart({ QString("Part %1").arg(i), "true" });
+                module->appendChild(part);
+                part->setPolyData(fileName, data);
+            }
+        }
+    };
+}
+
+// Loading ---------------------------------------------------------------------------
+
+/**
+ * @brief Parses an STL with the on-disk cache off, so every iteration reads the file.
+ */
+static void BM_LoadSTL(benchmark::State& state) {
+    const QString fileName = syntheticSTL(static_cast<int>(state.range(0)));
+    if (fileName.isEmpty()) {
+        state.SkipWithError("Could not write the test STL");
+        return;
+    }
+    GeometryCache::instance().setEnabled(false);
+
+    for (auto _ : state) {
+        auto part = std::make_unique<ModelPart>(QList<QVariant>{ "Part", "true" });
+        part->loadSTL(fileName);
+        benchmark::DoNotOptimize(part->getPolyData());
+
+        // Freeing the geometry is not part of loading it
+        state.PauseTiming();
+        part.reset();
+        GeometryInstances::instance().purge();
+        state.ResumeTiming();
+    }
+
+    GeometryCache::instance().setEnabled(true);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.counters["triangles"] = static_cast<double>(state.range(0));
+}
+BENCHMARK(BM_LoadSTL)->Arg(10000)->Arg(1000000)->Arg(10000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Filters ---------------------------------------------------------------------------
+
+enum FilterMode { Shrink, Clip, ShrinkAndClip };
+
+/**
+ * @brief Re-runs the filters of one part. The settings alternate between two values
+ * and the result cache is off, so every iteration executes the filters.
+ */
+static void BM_UpdateFilters(benchmark::State& state) {
+    const FilterMode mode = static_cast<FilterMode>(state.range(0));
+    ModelPart part({ "Part", "true" });
+    part.loadSTL(syntheticSTL(static_cast<int>(state.range(1))));
+    part.setFilterCacheBudget(0);
+
+    double normal[3] = { 0.0, -1.0, 0.0 };
+    bool flip = false;
+    for (auto _ : state) {
+        flip = !flip;
+        double origin[3] = { 0.5, flip ? 0.4 : 0.6, 0.0 };
+        const double factor = flip ? 0.8 : 0.7;
+
+        switch (mode) {
+        case Shrink:
+            part.applyShrinkFilter(true, factor);
+            break;
+        case Clip:
+            part.applyClipFilter(true, origin, normal);
+            break;
+        case ShrinkAndClip:
+            part.applyShrinkFilter(true, factor, false);
+            part.applyClipFilter(true, origin, normal);
+            break;
+        }
+        benchmark::DoNotOptimize(part.getPolyData());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_UpdateFilters)
+    ->ArgNames({ "mode", "triangles" })
+    ->ArgsProduct({ { Shrink, Clip, ShrinkAndClip }, { 100000, 1000000 } })
+    ->Unit(benchmark::kMillisecond);
+
+// Scene updates ---------------------------------------------------------------------
+
+/**
+ * @brief Adds a whole tree to an empty renderer through SceneSync, as loading an
+ * assembly does.
+ */
+static void BM_SceneSyncAddAll(benchmark::State& state) {
+    Assembly assembly(static_cast<int>(state.range(0)));
+    vtkNew<vtkRenderer> renderer;
+    SceneSync sync(renderer);
+
+    for (auto _ : state) {
+        sync.markAdded(assembly.module);
+        benchmark::DoNotOptimize(sync.apply());
+
+        state.PauseTiming();
+        sync.markRemoved(assembly.module);
+        sync.apply();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SceneSyncAddAll)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Pushes a change to one part into a renderer already showing the whole tree.
+ * This is what each edit in the GUI costs and should not grow with the tree.
+ */
+static void BM_SceneSyncChangeOne(benchmark::State& state) {
+    Assembly assembly(static_cast<int>(state.range(0)));
+    vtkNew<vtkRenderer> renderer;
+    SceneSync sync(renderer);
+    sync.markAdded(assembly.module);
+    sync.apply();
+
+    ModelPart* part = assembly.module->child(assembly.module->childCount() / 2);
+    bool visible = true;
+    for (auto _ : state) {
+        visible = !visible;
+        part->setVisible(visible);
+        sync.markChanged(part);
+        benchmark::DoNotOptimize(sync.apply());
+    }
+}
+BENCHMARK(BM_SceneSyncChangeOne)->RangeMultiplier(10)->Range(10, 100000)->Unit(benchmark::kMicrosecond);
+
+/**
+ * @brief Clears the renderer and adds every actor again, as the GUI did before
+ * SceneSync. Kept as the baseline the incremental path is measured against.
+ */
+static void BM_RebuildRenderer(benchmark::State& state) {
+    Assembly assembly(static_cast<int>(state.range(0)));
+    vtkNew<vtkRenderer> renderer;
+
+    for (auto _ : state) {
+        renderer->RemoveAllViewProps();
+        for (int i = 0; i < assembly.module->childCount(); ++i)
+            renderer->AddActor(assembly.module->child(i)->getActor());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RebuildRenderer)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMicrosecond);
+
+// Tree model ------------------------------------------------------------------------
+
+/**
+ * @brief Fetches every row of the module so index() sees all children.
+ */
+static QModelIndex fetchAll(ModelPartList& list) {
+    const QModelIndex module = list.index(0, 0, QModelIndex());
+    while (list.canFetchMore(module))
+        list.fetchMore(module);
+    return module;
+}
+
+static void BM_ModelIndex(benchmark::State& state) {
+    Assembly assembly(static_cast<int>(state.range(0)));
+    const QModelIndex module = fetchAll(*assembly.list);
+    const int rows = assembly.list->rowCount(module);
+
+    int row = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(assembly.list->index(row, 0, module));
+        row = (row + 7919) % rows;
+    }
+}
+BENCHMARK(BM_ModelIndex)->RangeMultiplier(10)->Range(10, 100000);
+
+static void BM_ModelParent(benchmark::State& state) {
+    Assembly assembly(static_cast<int>(state.range(0)));
+    const QModelIndex module = fetchAll(*assembly.list);
+    const int rows = assembly.list->rowCount(module);
+
+    std::vector<QModelIndex> indexes;
+    for (int i = 0; i < rows; ++i)
+        indexes.push_back(assembly.list->index(i, 0, module));
+
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(assembly.list->parent(indexes[i]));
+        i = (i + 7919) % indexes.size();
+    }
+}
+BENCHMARK(BM_ModelParent)->RangeMultiplier(10)->Range(10, 100000);
+
+/**
+ * @brief Looks up the rows of a module's children after a removal at the front has
+ * renumbered them.
+ *
+ * The removal and the renumbering pass it triggers are left out of the measurement,
+ * which covers a run of row() lookups across the siblings.
+ */
+static void BM_ModelPartRow(benchmark::State& state) {
+    const int lookups = 1024;
+    Assembly assembly(static_cast<int>(state.range(0)) + 1);
+
+    for (auto _ : state) {
+        assembly.module->removeChildren(0, 1);
+        assembly.module->appendChild(new ModelPart({ "Part", "true" }));
+        ModelPart* module = assembly.module;
+        const int count = module->childCount();
+        module->child(count - 1)->row();
+
+        const auto start = std::chrono::steady_clock::now();
+        int child = 0;
+        for (int i = 0; i < lookups; ++i) {
+            benchmark::DoNotOptimize(module->child(child)->row());
+            child = (child + 7919) % count;
+        }
+        const auto end = std::chrono::steady_clock::now();
+        state.SetIterationTime(std::chrono::duration<double>(end - start).count());
+    }
+    state.SetItemsProcessed(state.iterations() * lookups);
+}
+BENCHMARK(BM_ModelPartRow)->RangeMultiplier(10)->Range(10, 100000)->UseManualTime();
+
+// Rendering -------------------------------------------------------------------------
+
+/**
+ * @brief Renders a tree offscreen. Skipped when no OpenGL context can be created.
+ */
+static void BM_OffscreenFrame(benchmark::State& state) {
+    Assembly assembly(static_cast<int>(state.range(0)));
+    vtkNew<vtkRenderer> renderer;
+    SceneSync sync(renderer);
+    sync.markAdded(assembly.module);
+    sync.apply();
+    renderer->ResetCamera();
+
+    vtkNew<vtkRenderWindow> window;
+    window->SetOffScreenRendering(1);
+    window->SetSize(1280, 720);
+    window->AddRenderer(renderer);
+    window->Render();
+    if (!window->SupportsOpenGL()) {
+        state.SkipWithError("No OpenGL context for offscreen rendering");
+        return;
+    }
+
+    for (auto _ : state) {
+        renderer->GetActiveCamera()->Azimuth(1.0);
+        window->Render();
+        window->WaitForCompletion();
+    }
+    state.counters["fps"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_OffscreenFrame)->RangeMultiplier(10)->Range(10, 10000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
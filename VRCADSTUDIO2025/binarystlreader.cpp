@@ -0,0 +1,160 @@
+#include "binarystlreader.h"
+
+#include <QFile>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QSysInfo>
+#include <QtEndian>
+
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkCellArray.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    const qint64 HeaderSize = 80;      // Free-form header text
+    const qint64 RecordOffset = 84;    // Header plus the 32-bit triangle count
+    const qint64 RecordSize = 50;      // Normal, three vertices and a 16-bit attribute
+    const qint64 HashBlock = 65536;    // Triangles hashed ahead of each parallel pass
+
+    void addData(QCryptographicHash* hash, const uchar* data, qint64 bytes) {
+        hash->addData(QByteArray::fromRawData(reinterpret_cast<const char*>(data), int(bytes)));
+    }
+
+    /**
+     * @brief Returns the number of triangles a mapped file holds, or -1 if it is not binary.
+     */
+    qint64 binaryTriangleCount(const uchar* data, qint64 size) {
+        if (size < RecordOffset)
+            return -1;
+
+        const qint64 count = qFromLittleEndian<quint32>(data + HeaderSize);
+        const qint64 expected = RecordOffset + RecordSize * count;
+
+        if (expected == size)
+            return count;
+
+        // Some exporters pad the file. Only accept that when the header cannot be ASCII.
+        if (expected < size && std::strncmp(reinterpret_cast<const char*>(data), "solid", 5) != 0)
+            return count;
+
+        return -1;
+    }
+}
+
+/**
+ * @brief Checks the header of a file against the binary STL layout.
+ */
+bool IsBinarySTL(const QString& fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QByteArray header = file.read(RecordOffset);
+    if (header.size() < RecordOffset)
+        return false;
+
+    return binaryTriangleCount(reinterpret_cast<const uchar*>(header.constData()), file.size()) >= 0;
+}
+
+/**
+ * @brief Maps a binary STL file and converts it to poly data in one pass.
+ */
+vtkSmartPointer<vtkPolyData> ReadBinarySTL(const QString& fileName, STLReadStats* stats,
+                                           QCryptographicHash* hash) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // The records are copied as raw little-endian floats
+    if (QSysInfo::ByteOrder != QSysInfo::LittleEndian)
+        return nullptr;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    const qint64 size = file.size();
+    if (size < RecordOffset)
+        return nullptr;
+
+    uchar* data = file.map(0, size);
+    if (!data)
+        return nullptr;
+
+    const qint64 count = binaryTriangleCount(data, size);
+    if (count <= 0) {
+        file.unmap(data);
+        return nullptr;
+    }
+
+    const vtkIdType triangles = static_cast<vtkIdType>(count);
+
+    vtkNew<vtkFloatArray> coords;
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(3 * triangles);
+
+    vtkNew<vtkIdTypeArray> offsets;
+    offsets->SetNumberOfTuples(triangles + 1);
+
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->SetNumberOfTuples(3 * triangles);
+
+    float* p = coords->GetPointer(0);
+    vtkIdType* o = offsets->GetPointer(0);
+    vtkIdType* c = connectivity->GetPointer(0);
+    const uchar* records = data + RecordOffset;
+
+    auto convert = [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i) {
+            // Records are 50 bytes long, so the floats are not aligned - copy them out
+            float* v = p + 9 * i;
+            std::memcpy(v, records + RecordSize * i + 12, 9 * sizeof(float));
+
+            o[i] = 3 * i;
+            c[3 * i] = 3 * i;
+            c[3 * i + 1] = 3 * i + 1;
+            c[3 * i + 2] = 3 * i + 2;
+        }
+    };
+
+    if (hash) {
+        // Hash each block on this thread while its pages are hot, then convert it in parallel
+        addData(hash, data, RecordOffset);
+        for (vtkIdType begin = 0; begin < triangles; begin += HashBlock) {
+            const vtkIdType end = std::min<vtkIdType>(begin + HashBlock, triangles);
+            addData(hash, records + RecordSize * begin, RecordSize * (end - begin));
+            vtkSMPTools::For(begin, end, convert);
+        }
+        const qint64 tail = size - (RecordOffset + RecordSize * count);
+        if (tail > 0)
+            addData(hash, records + RecordSize * count, tail);
+    }
+    else {
+        vtkSMPTools::For(0, triangles, convert);
+    }
+    o[triangles] = 3 * triangles;
+
+    file.unmap(data);
+
+    vtkNew<vtkPoints> points;
+    points->SetData(coords);
+
+    vtkNew<vtkCellArray> polys;
+    polys->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(points);
+    output->SetPolys(polys);
+
+    if (stats) {
+        stats->bytes = size;
+        stats->seconds = timer.nsecsElapsed() / 1e9;
+    }
+
+    return output;
+}
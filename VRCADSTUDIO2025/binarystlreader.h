@@ -0,0 +1,61 @@
+#ifndef BINARY_STL_READER_H
+#define BINARY_STL_READER_H
+
+#include <QString>
+#include <QtGlobal>
+
+class QCryptographicHash;
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file
+ * This file contains a fast reader for binary STL files that maps the file
+ * into memory and fills the VTK arrays in a single bulk pass.
+ */
+
+/**
+ * @brief Timing information for a single STL read.
+ */
+struct STLReadStats {
+    qint64 bytes = 0;       /**< Size of the file in bytes */
+    double seconds = 0.0;   /**< Wall-clock time spent reading */
+
+    /**
+     * @brief Returns the read throughput in MB/s.
+     */
+    double megabytesPerSecond() const {
+        return seconds > 0.0 ? (bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+    }
+};
+
+/**
+ * @brief Checks whether a file has the size and header of a binary STL.
+ *
+ * @param fileName Path to the STL file.
+ * @return true if the triangle count in the header matches the file size.
+ */
+bool IsBinarySTL(const QString& fileName);
+
+/**
+ * @brief Reads a binary STL file into poly data.
+ *
+ * The file is memory mapped and every triangle record is copied straight into
+ * preallocated point and connectivity arrays, split across cores with
+ * vtkSMPTools. The stored facet normals are skipped, as normals are computed
+ * after welding. Each triangle keeps its own three points; no point merging
+ * is done here. Safe to call from any thread.
+ *
+ * When a hash is given, the whole file is added to it block by block as the
+ * records are converted, so the file does not need a second read to be hashed.
+ *
+ * @param fileName Path to the STL file.
+ * @param stats Optional output for the bytes read and time taken.
+ * @param hash Optional hash to add the file's contents to. Only complete when the read succeeds.
+ * @return The geometry, or nullptr if the file is not a binary STL or cannot be mapped.
+ */
+vtkSmartPointer<vtkPolyData> ReadBinarySTL(const QString& fileName, STLReadStats* stats = nullptr,
+                                           QCryptographicHash* hash = nullptr);
+
+#endif // BINARY_STL_READER_H
@@ -0,0 +1,193 @@
+#include "filtercache.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+
+bool FilterKey::operator==(const FilterKey& other) const {
+    if (shrinkEnabled != other.shrinkEnabled || clipEnabled != other.clipEnabled)
+        return false;
+
+    if (shrinkEnabled && shrinkFactor != other.shrinkFactor)
+        return false;
+
+    if (clipEnabled) {
+        for (int i = 0; i < 3; i++) {
+            if (clipOrigin[i] != other.clipOrigin[i] || clipNormal[i] != other.clipNormal[i])
+                return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief State shared by every cache: the entries of all parts in one LRU list.
+ */
+struct FilterResultCache::Shared {
+    QMutex mutex;                                   /**< Guards every cache */
+    EntryList entries;                              /**< Most recently used first */
+    qint64 budgetBytes = qint64(1024) * 1024 * 1024; /**< Process-wide budget */
+    qint64 heldBytes = 0;                           /**< Memory held by all entries */
+};
+
+FilterResultCache::Shared& FilterResultCache::shared() {
+    static Shared state;
+    return state;
+}
+
+FilterResultCache::FilterResultCache(qint64 budgetBytes)
+    : budgetBytes(budgetBytes)
+{
+}
+
+FilterResultCache::~FilterResultCache() {
+    clear();
+}
+
+/**
+ * @brief Finds a result by its parameters. There are only ever a handful of entries per part, so a linear scan is used.
+ */
+vtkSmartPointer<vtkPolyData> FilterResultCache::find(const FilterKey& key) {
+    QMutexLocker locker(&shared().mutex);
+    for (EntryList::iterator entry : entries) {
+        if (entry->key == key) {
+            touch(entry);
+            hitCount++;
+            return entry->data;
+        }
+    }
+
+    missCount++;
+    return nullptr;
+}
+
+void FilterResultCache::insert(const FilterKey& key, vtkPolyData* data) {
+    QMutexLocker locker(&shared().mutex);
+    for (EntryList::iterator entry : entries) {
+        if (entry->key == key) {
+            remove(entry);
+            break;
+        }
+    }
+
+    // GetActualMemorySize() reports kibibytes
+    Shared& state = shared();
+    state.entries.push_front(Entry{ this, key, data, static_cast<qint64>(data->GetActualMemorySize()) * 1024 });
+    entries.push_back(state.entries.begin());
+    heldBytes += state.entries.front().bytes;
+    state.heldBytes += state.entries.front().bytes;
+    current = state.entries.begin();
+    hasCurrent = true;
+
+    trim();
+    trimShared();
+}
+
+void FilterResultCache::clear() {
+    QMutexLocker locker(&shared().mutex);
+    while (!entries.empty())
+        remove(entries.back());
+}
+
+void FilterResultCache::setBudget(qint64 bytes) {
+    QMutexLocker locker(&shared().mutex);
+    budgetBytes = bytes;
+    trim();
+}
+
+qint64 FilterResultCache::budget() const {
+    QMutexLocker locker(&shared().mutex);
+    return budgetBytes;
+}
+
+qint64 FilterResultCache::bytes() const {
+    QMutexLocker locker(&shared().mutex);
+    return heldBytes;
+}
+
+int FilterResultCache::size() const {
+    QMutexLocker locker(&shared().mutex);
+    return static_cast<int>(entries.size());
+}
+
+quint64 FilterResultCache::hits() const {
+    QMutexLocker locker(&shared().mutex);
+    return hitCount;
+}
+
+quint64 FilterResultCache::misses() const {
+    QMutexLocker locker(&shared().mutex);
+    return missCount;
+}
+
+void FilterResultCache::setSharedBudget(qint64 bytes) {
+    QMutexLocker locker(&shared().mutex);
+    shared().budgetBytes = bytes;
+    trimShared();
+}
+
+qint64 FilterResultCache::sharedBudget() {
+    QMutexLocker locker(&shared().mutex);
+    return shared().budgetBytes;
+}
+
+qint64 FilterResultCache::sharedBytes() {
+    QMutexLocker locker(&shared().mutex);
+    return shared().heldBytes;
+}
+
+/**
+ * @brief Marks an entry as most recently used and as the one the mapper shows. Mutex must be held.
+ */
+void FilterResultCache::touch(EntryList::iterator entry) {
+    EntryList& list = shared().entries;
+    list.splice(list.begin(), list, entry);
+    current = entry;
+    hasCurrent = true;
+}
+
+/**
+ * @brief Drops one of this cache's entries. Mutex must be held.
+ */
+void FilterResultCache::remove(EntryList::iterator entry) {
+    if (hasCurrent && current == entry)
+        hasCurrent = false;
+
+    entries.erase(std::find(entries.begin(), entries.end(), entry));
+    heldBytes -= entry->bytes;
+    shared().heldBytes -= entry->bytes;
+    shared().entries.erase(entry);
+}
+
+/**
+ * @brief Drops this cache's least recently used entries until its own budget is met. Mutex must be held.
+ *
+ * The current entry is always kept, even on its own over budget, as the mapper is using it.
+ */
+void FilterResultCache::trim() {
+    EntryList& list = shared().entries;
+    for (auto it = list.end(); heldBytes > budgetBytes && it != list.begin();) {
+        --it;
+        if (it->owner != this || (hasCurrent && it == current))
+            continue;
+        remove(it++);
+    }
+}
+
+/**
+ * @brief Drops the least recently used entries of any cache until the shared budget is met. Mutex must be held.
+ *
+ * Entries a cache is currently showing are skipped.
+ */
+void FilterResultCache::trimShared() {
+    Shared& state = shared();
+    for (auto it = state.entries.end(); state.heldBytes > state.budgetBytes && it != state.entries.begin();) {
+        --it;
+        FilterResultCache* owner = it->owner;
+        if (owner->hasCurrent && it == owner->current)
+            continue;
+        owner->remove(it++);
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef FILTER_CACHE_H
+#define FILTER_CACHE_H
+
+#include <QtGlobal>
+
+#include <list>
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file
+ * This file contains the FilterResultCache class, a small memory-budgeted LRU
+ * cache of filtered geometry used by ModelPart, with a budget shared by every part.
+ */
+
+/**
+ * @brief The filter parameters a cached result was produced with.
+ */
+struct FilterKey {
+    bool shrinkEnabled = false;     /**< Shrink stage enabled */
+    double shrinkFactor = 0.0;      /**< Shrink factor */
+    bool clipEnabled = false;       /**< Clip stage enabled */
+    double clipOrigin[3] = {};      /**< Clip plane origin */
+    double clipNormal[3] = {};      /**< Clip plane normal */
+
+    /**
+     * @brief Compares two keys. Parameters of disabled stages are ignored.
+     */
+    bool operator==(const FilterKey& other) const;
+};
+
+ /**
+  * @class FilterResultCache
+  * @brief Keeps recently used filter outputs so switching back to a previous filter state is a pointer swap.
+  *
+  * Entries are standalone poly data detached from the filter pipeline. The least
+  * recently used entries are dropped once the memory they hold exceeds the budget.
+  *
+  * Besides its own budget, every cache counts against one process-wide budget, so a
+  * large assembly cannot hold a full budget per part. When the shared budget is
+  * exceeded the least recently used entries of any part are dropped. The entry each
+  * part last returned is never dropped, as its mapper is drawing it.
+  *
+  * Thread safe. Parts filtered on different workers share one lock, which is only
+  * held for the lookups and never while filtering.
+  */
+class FilterResultCache {
+public:
+    /**
+     * @brief Constructs an empty cache.
+     * @param budgetBytes Maximum memory the cached outputs may hold.
+     */
+    explicit FilterResultCache(qint64 budgetBytes = 256 * 1024 * 1024);
+
+    /**
+     * @brief Releases the entries of this cache from the shared budget.
+     */
+    ~FilterResultCache();
+
+    FilterResultCache(const FilterResultCache&) = delete;
+    FilterResultCache& operator=(const FilterResultCache&) = delete;
+
+    /**
+     * @brief Looks up a result and marks it as most recently used.
+     * @return The cached output, or nullptr on a miss.
+     */
+    vtkSmartPointer<vtkPolyData> find(const FilterKey& key);
+
+    /**
+     * @brief Adds a result, dropping the least recently used ones if over budget.
+     * @param key Parameters the result was produced with.
+     * @param data The result. It must not be modified afterwards.
+     */
+    void insert(const FilterKey& key, vtkPolyData* data);
+
+    /**
+     * @brief Drops every entry, e.g. when the input geometry changes.
+     */
+    void clear();
+
+    /**
+     * @brief Sets the memory budget and drops entries until it is met.
+     */
+    void setBudget(qint64 bytes);
+
+    /**
+     * @brief Returns the memory budget in bytes.
+     */
+    qint64 budget() const;
+
+    /**
+     * @brief Returns the memory currently held by cached outputs in bytes.
+     */
+    qint64 bytes() const;
+
+    /**
+     * @brief Returns the number of cached outputs.
+     */
+    int size() const;
+
+    /**
+     * @brief Returns the number of lookups that found an entry.
+     */
+    quint64 hits() const;
+
+    /**
+     * @brief Returns the number of lookups that did not find an entry.
+     */
+    quint64 misses() const;
+
+    /**
+     * @brief Sets the budget shared by every cache in the process and drops entries until it is met.
+     */
+    static void setSharedBudget(qint64 bytes);
+
+    /**
+     * @brief Returns the budget shared by every cache in bytes. Defaults to 1 GB.
+     */
+    static qint64 sharedBudget();
+
+    /**
+     * @brief Returns the memory held by every cache in bytes.
+     */
+    static qint64 sharedBytes();
+
+private:
+    /**
+     * @brief A cached output, its size and its owner.
+     */
+    struct Entry {
+        FilterResultCache* owner;
+        FilterKey key;
+        vtkSmartPointer<vtkPolyData> data;
+        qint64 bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    struct Shared;
+    static Shared& shared();
+
+    void touch(EntryList::iterator entry);
+    void remove(EntryList::iterator entry);
+    void trim();
+    static void trimShared();
+
+    std::vector<EntryList::iterator> entries;   /**< This cache's entries in the shared list */
+    EntryList::iterator current;                /**< Entry last returned, in use by the mapper */
+    bool hasCurrent = false;                    /**< Whether current is set */
+    qint64 budgetBytes;                         /**< Memory budget */
+    qint64 heldBytes = 0;                       /**< Memory held by entries */
+    quint64 hitCount = 0;                       /**< Lookups that found an entry */
+    quint64 missCount = 0;                      /**< Lookups that did not find an entry */
+};
+
+#endif // FILTER_CACHE_H
@@ -0,0 +1,83 @@
+#include "framescheduler.h"
+#include "profiler.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Constructs the scheduler, pacing frames to the primary screen's refresh rate.
+ */
+FrameScheduler::FrameScheduler(vtkRenderWindow* window, QObject* parent)
+    : QObject(parent), window(window)
+{
+    QScreen* screen = QGuiApplication::primaryScreen();
+    const double refreshRate = screen && screen->refreshRate() > 0 ? screen->refreshRate() : 60.0;
+    // Round up: rounding down paces faster than the display, e.g. 16 ms at 60 Hz
+    interval = static_cast<int>(std::ceil(1000.0 / refreshRate));
+
+    timer.setSingleShot(true);
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &FrameScheduler::renderFrame);
+}
+
+/**
+ * @brief Schedules a frame no sooner than one interval after the last one.
+ */
+void FrameScheduler::requestFrame() {
+    if (timer.isActive()) {
+        skipped++;
+        return;
+    }
+
+    int delay = 0;
+    if (sinceLastFrame.isValid())
+        delay = std::max(0, interval - static_cast<int>(sinceLastFrame.elapsed()));
+    timer.start(delay);
+}
+
+void FrameScheduler::setAnimating(bool animating) {
+    this->animating = animating;
+    if (animating)
+        requestFrame();
+}
+
+bool FrameScheduler::isAnimating() const {
+    return animating;
+}
+
+void FrameScheduler::setFrameInterval(int milliseconds) {
+    interval = std::max(0, milliseconds);
+}
+
+quint64 FrameScheduler::framesRendered() const {
+    return rendered;
+}
+
+quint64 FrameScheduler::framesSkipped() const {
+    return skipped;
+}
+
+/**
+ * @brief Lets animations advance by the elapsed time, renders, then schedules the next
+ * frame if still animating.
+ */
+void FrameScheduler::renderFrame() {
+    PROFILE_SCOPE("FrameScheduler::renderFrame");
+    const double dt = idle || !sinceLastFrame.isValid() ? 0.0 : sinceLastFrame.nsecsElapsed() / 1e9;
+    sinceLastFrame.start();
+
+    emit frameStarted(dt);
+
+    {
+        PROFILE_SCOPE("vtkRenderWindow::Render");
+        window->Render();
+    }
+    rendered++;
+
+    idle = !animating;
+    if (animating)
+        requestFrame();
+}
@@ -0,0 +1,90 @@
+#ifndef FRAME_SCHEDULER_H
+#define FRAME_SCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+
+/**
+ * @file
+ * This file contains the declaration of the FrameScheduler class, which renders
+ * the desktop view on demand.
+ */
+
+ /**
+  * @class FrameScheduler
+  * @brief Coalesces render requests into at most one render per display refresh.
+  *
+  * Anything that changes the scene calls requestFrame() instead of rendering
+  * directly. Requests made before the pending frame is drawn are merged into it,
+  * so a burst of edits costs one render. While something is animating, a new frame
+  * is requested after each one; otherwise no timer runs and the scheduler sleeps.
+  */
+class FrameScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the scheduler for a render window.
+     * @param window The window rendered on each frame.
+     * @param parent Parent QObject.
+     */
+    explicit FrameScheduler(vtkRenderWindow* window, QObject* parent = nullptr);
+
+    /**
+     * @brief Asks for the scene to be rendered at the next refresh.
+     */
+    void requestFrame();
+
+    /**
+     * @brief Keeps rendering every refresh while true, emitting frameStarted() each time.
+     */
+    void setAnimating(bool animating);
+
+    /**
+     * @brief Returns whether frames are being rendered continuously.
+     */
+    bool isAnimating() const;
+
+    /**
+     * @brief Sets the minimum time between frames, by default one display refresh.
+     */
+    void setFrameInterval(int milliseconds);
+
+    /**
+     * @brief Returns the number of frames rendered.
+     */
+    quint64 framesRendered() const;
+
+    /**
+     * @brief Returns the number of requests merged into an already pending frame.
+     */
+    quint64 framesSkipped() const;
+
+signals:
+    /**
+     * @brief Emitted just before each frame is rendered.
+     * @param dt Seconds since the previous frame, 0 for the first frame after idling.
+     */
+    void frameStarted(double dt);
+
+private:
+    /**
+     * @brief Renders the pending frame.
+     */
+    void renderFrame();
+
+    vtkSmartPointer<vtkRenderWindow> window;  /**< Window rendered on each frame */
+    QTimer timer;                             /**< Single-shot timer for the pending frame */
+    QElapsedTimer sinceLastFrame;             /**< Time since the last frame was rendered */
+    int interval;                             /**< Minimum milliseconds between frames */
+    bool animating = false;                   /**< Whether to render continuously */
+    bool idle = true;                         /**< Whether the last frame ended a run of frames */
+    quint64 rendered = 0;                     /**< Frames rendered */
+    quint64 skipped = 0;                      /**< Requests merged into a pending frame */
+};
+
+#endif // FRAME_SCHEDULER_H
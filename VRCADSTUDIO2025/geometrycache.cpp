@@ -0,0 +1,494 @@
+#include "geometrycache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDebug>
+#include <QSet>
+
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkFloatArray.h>
+#include <vtkTypeInt64Array.h>
+#include <vtkCellArray.h>
+#include <vtkPointData.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace {
+    const char EntryMagic[8] = { 'V', 'R', 'C', 'A', 'D', 'G', 'C', '\0' };
+    const quint32 EntryVersion = 1;
+    const QString IndexFileName = QStringLiteral("index.json");
+    const QString EntrySuffix = QStringLiteral(".vgc");
+
+    /**
+     * @brief Fixed header at the start of each entry file. All counts are in elements.
+     */
+    struct EntryHeader {
+        char magic[8];
+        quint32 version;
+        quint32 hasNormals;
+        qint64 numPoints;
+        qint64 numCells;
+        qint64 connectivitySize;
+    };
+    static_assert(sizeof(EntryHeader) % 8 == 0, "sections must stay 8-byte aligned");
+
+    qint64 padded(qint64 bytes) {
+        return (bytes + 7) & ~qint64(7);
+    }
+
+    qint64 entrySize(const EntryHeader& h) {
+        const qint64 pointBytes = padded(h.numPoints * 3 * qint64(sizeof(float)));
+        return qint64(sizeof(EntryHeader))
+            + pointBytes
+            + (h.hasNormals ? pointBytes : 0)
+            + (h.numCells + 1) * qint64(sizeof(qint64))
+            + h.connectivitySize * qint64(sizeof(qint64));
+    }
+
+    bool writePadded(QSaveFile& file, const void* data, qint64 bytes) {
+        static const char zeros[8] = {};
+        if (file.write(static_cast<const char*>(data), bytes) != bytes)
+            return false;
+        const qint64 pad = padded(bytes) - bytes;
+        return file.write(zeros, pad) == pad;
+    }
+
+    /**
+     * @brief Returns the array as float, converting only when it is stored as another type.
+     */
+    vtkSmartPointer<vtkFloatArray> asFloat(vtkDataArray* array) {
+        vtkSmartPointer<vtkFloatArray> result = vtkFloatArray::FastDownCast(array);
+        if (!result) {
+            result = vtkSmartPointer<vtkFloatArray>::New();
+            result->DeepCopy(array);
+        }
+        return result;
+    }
+}
+
+GeometryCache& GeometryCache::instance() {
+    static GeometryCache cache;
+    return cache;
+}
+
+/**
+ * @brief Creates the cache in the user's cache directory with a 4 GB cap.
+ */
+GeometryCache::GeometryCache()
+    : maxCacheBytes(qint64(4) * 1024 * 1024 * 1024)
+{
+    setDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/geometry");
+}
+
+GeometryCache::~GeometryCache() {
+    flush();
+}
+
+void GeometryCache::setDirectory(const QString& path) {
+    QMutexLocker locker(&mutex);
+    if (indexDirty && !cacheDir.isEmpty())
+        saveIndex();
+    indexDirty = false;
+    cacheDir = path;
+    enabled = QDir().mkpath(cacheDir);
+    if (!enabled)
+        qDebug() << "Geometry cache disabled, cannot create" << cacheDir;
+    loadIndex();
+}
+
+QString GeometryCache::directory() const {
+    QMutexLocker locker(&mutex);
+    return cacheDir;
+}
+
+void GeometryCache::setMaxBytes(qint64 bytes) {
+    QMutexLocker locker(&mutex);
+    maxCacheBytes = bytes;
+    evict();
+    saveIndex();
+    indexDirty = false;
+}
+
+qint64 GeometryCache::maxBytes() const {
+    QMutexLocker locker(&mutex);
+    return maxCacheBytes;
+}
+
+qint64 GeometryCache::bytesOnDisk() const {
+    QMutexLocker locker(&mutex);
+    return totalBytes;
+}
+
+void GeometryCache::setEnabled(bool enable) {
+    QMutexLocker locker(&mutex);
+    enabled = enable;
+}
+
+bool GeometryCache::isEnabled() const {
+    QMutexLocker locker(&mutex);
+    return enabled;
+}
+
+/**
+ * @brief Returns the MD5 of a file's contents.
+ *
+ * The hash is only recomputed when the file's size or modification time has
+ * changed since it was last recorded.
+ */
+QByteArray GeometryCache::contentHash(const QString& fileName) {
+    const QByteArray known = knownHash(fileName);
+    if (!known.isEmpty())
+        return known;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    if (!hash.addData(&file))
+        return QByteArray();
+
+    const QByteArray result = hash.result().toHex();
+    recordHash(fileName, result);
+    return result;
+}
+
+QByteArray GeometryCache::knownHash(const QString& fileName) {
+    const QFileInfo info(fileName);
+
+    QMutexLocker locker(&mutex);
+    auto it = sources.constFind(info.absoluteFilePath());
+    if (it != sources.constEnd() && it->size == info.size()
+        && it->modified == info.lastModified().toMSecsSinceEpoch())
+        return it->hash;
+    return QByteArray();
+}
+
+void GeometryCache::recordHash(const QString& fileName, const QByteArray& hash) {
+    const QFileInfo info(fileName);
+    SourceRecord record;
+    record.size = info.size();
+    record.modified = info.lastModified().toMSecsSinceEpoch();
+    record.hash = hash;
+
+    QMutexLocker locker(&mutex);
+    sources.insert(info.absoluteFilePath(), record);
+    indexDirty = true;
+}
+
+/**
+ * @brief Names an entry after the content hash and the processing settings.
+ */
+QString GeometryCache::entryName(const QByteArray& hash, double weldTolerance) const {
+    if (hash.isEmpty())
+        return QString();
+
+    const QByteArray key = hash + '/' + QByteArray::number(weldTolerance, 'g', 17)
+        + '/' + QByteArray::number(EntryVersion);
+    return QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex());
+}
+
+QString GeometryCache::entryPath(const QString& name) const {
+    return cacheDir + '/' + name + EntrySuffix;
+}
+
+/**
+ * @brief Maps a cached entry and copies its sections into new VTK arrays.
+ */
+vtkSmartPointer<vtkPolyData> GeometryCache::load(const QByteArray& hash, double weldTolerance) {
+    if (!isEnabled())
+        return nullptr;
+
+    const QString name = entryName(hash, weldTolerance);
+    QString path;
+    {
+        QMutexLocker locker(&mutex);
+        if (name.isEmpty() || !entries.contains(name)) {
+            missCount++;
+            return nullptr;
+        }
+        path = entryPath(name);
+    }
+
+    QFile file(path);
+    uchar* data = nullptr;
+    if (file.open(QIODevice::ReadOnly))
+        data = file.map(0, file.size());
+
+    EntryHeader header;
+    if (data && file.size() >= qint64(sizeof(header)))
+        std::memcpy(&header, data, sizeof(header));
+
+    if (!data || file.size() < qint64(sizeof(header))
+        || std::memcmp(header.magic, EntryMagic, sizeof(EntryMagic)) != 0
+        || header.version != EntryVersion
+        || entrySize(header) != file.size()) {
+        // Missing, truncated or from another version - drop it
+        if (data)
+            file.unmap(data);
+        file.close();
+
+        QMutexLocker locker(&mutex);
+        totalBytes -= entries.value(name).bytes;
+        entries.remove(name);
+        QFile::remove(path);
+        indexDirty = true;
+        missCount++;
+        return nullptr;
+    }
+
+    const uchar* section = data + sizeof(EntryHeader);
+    const qint64 pointBytes = header.numPoints * 3 * qint64(sizeof(float));
+
+    vtkNew<vtkFloatArray> coords;
+    coords->SetNumberOfComponents(3);
+    coords->SetNumberOfTuples(header.numPoints);
+    std::memcpy(coords->GetPointer(0), section, pointBytes);
+    section += padded(pointBytes);
+
+    vtkSmartPointer<vtkFloatArray> normals;
+    if (header.hasNormals) {
+        normals = vtkSmartPointer<vtkFloatArray>::New();
+        normals->SetName("Normals");
+        normals->SetNumberOfComponents(3);
+        normals->SetNumberOfTuples(header.numPoints);
+        std::memcpy(normals->GetPointer(0), section, pointBytes);
+        section += padded(pointBytes);
+    }
+
+    vtkNew<vtkTypeInt64Array> offsets;
+    offsets->SetNumberOfValues(header.numCells + 1);
+    std::memcpy(offsets->GetPointer(0), section, (header.numCells + 1) * sizeof(qint64));
+    section += (header.numCells + 1) * sizeof(qint64);
+
+    vtkNew<vtkTypeInt64Array> connectivity;
+    connectivity->SetNumberOfValues(header.connectivitySize);
+    std::memcpy(connectivity->GetPointer(0), section, header.connectivitySize * sizeof(qint64));
+
+    file.unmap(data);
+
+    vtkNew<vtkPoints> points;
+    points->SetData(coords);
+
+    vtkNew<vtkCellArray> polys;
+    polys->SetData(offsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(points);
+    output->SetPolys(polys);
+    if (normals)
+        output->GetPointData()->SetNormals(normals);
+
+    QMutexLocker locker(&mutex);
+    auto it = entries.find(name);
+    if (it != entries.end())
+        it->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    hitCount++;
+    indexDirty = true;
+
+    return output;
+}
+
+/**
+ * @brief Writes an entry through a temporary file so readers never see a partial entry.
+ */
+void GeometryCache::store(const QByteArray& hash, double weldTolerance, vtkPolyData* data) {
+    if (!isEnabled() || !data || !data->GetPoints() || !data->GetPolys())
+        return;
+
+    const QString name = entryName(hash, weldTolerance);
+    if (name.isEmpty())
+        return;
+
+    vtkSmartPointer<vtkFloatArray> coords = asFloat(data->GetPoints()->GetData());
+    vtkSmartPointer<vtkFloatArray> normals;
+    if (data->GetPointData()->GetNormals())
+        normals = asFloat(data->GetPointData()->GetNormals());
+
+    // Entries always hold 64-bit cell storage; convert a copy if the data uses 32-bit ids
+    vtkSmartPointer<vtkCellArray> polys = data->GetPolys();
+    if (!polys->IsStorage64Bit()) {
+        polys = vtkSmartPointer<vtkCellArray>::New();
+        polys->DeepCopy(data->GetPolys());
+        polys->ConvertTo64BitStorage();
+    }
+    vtkTypeInt64Array* offsets = polys->GetOffsetsArray64();
+    vtkTypeInt64Array* connectivity = polys->GetConnectivityArray64();
+
+    EntryHeader header;
+    std::memcpy(header.magic, EntryMagic, sizeof(EntryMagic));
+    header.version = EntryVersion;
+    header.hasNormals = normals ? 1 : 0;
+    header.numPoints = coords->GetNumberOfTuples();
+    header.numCells = polys->GetNumberOfCells();
+    header.connectivitySize = connectivity->GetNumberOfValues();
+
+    const qint64 pointBytes = header.numPoints * 3 * qint64(sizeof(float));
+
+    QSaveFile file(entryPath(name));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    bool ok = writePadded(file, &header, sizeof(header))
+        && writePadded(file, coords->GetPointer(0), pointBytes)
+        && (!normals || writePadded(file, normals->GetPointer(0), pointBytes))
+        && writePadded(file, offsets->GetPointer(0), (header.numCells + 1) * sizeof(qint64))
+        && writePadded(file, connectivity->GetPointer(0), header.connectivitySize * sizeof(qint64));
+
+    if (!ok || !file.commit()) {
+        qDebug() << "Failed to write geometry cache entry" << name;
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    EntryRecord& record = entries[name];
+    totalBytes += entrySize(header) - record.bytes;
+    record.bytes = entrySize(header);
+    record.lastUsed = QDateTime::currentMSecsSinceEpoch();
+    record.hash = hash;
+    indexDirty = true;
+
+    evict();
+}
+
+void GeometryCache::flush() {
+    QMutexLocker locker(&mutex);
+    if (!indexDirty)
+        return;
+    pruneSources();
+    saveIndex();
+    indexDirty = false;
+}
+
+/**
+ * @brief Deletes the least recently used entries until the cache fits its cap. Mutex must be held.
+ */
+void GeometryCache::evict() {
+    if (totalBytes <= maxCacheBytes)
+        return;
+
+    std::vector<std::pair<qint64, QString>> byAge;
+    byAge.reserve(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        byAge.emplace_back(it->lastUsed, it.key());
+    std::sort(byAge.begin(), byAge.end());
+
+    for (const auto& entry : byAge) {
+        if (totalBytes <= maxCacheBytes)
+            break;
+        QFile::remove(entryPath(entry.second));
+        totalBytes -= entries.value(entry.second).bytes;
+        entries.remove(entry.second);
+        indexDirty = true;
+    }
+    pruneSources();
+}
+
+/**
+ * @brief Forgets paths whose contents have no entry any more, so the index only
+ * grows with the entries it describes. Mutex must be held.
+ */
+void GeometryCache::pruneSources() {
+    QSet<QByteArray> cached;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        cached.insert(it->hash);
+
+    for (auto it = sources.begin(); it != sources.end();) {
+        if (!cached.contains(it->hash)) {
+            it = sources.erase(it);
+            indexDirty = true;
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Reads the path and entry records. Mutex must be held.
+ */
+void GeometryCache::loadIndex() {
+    sources.clear();
+    entries.clear();
+    totalBytes = 0;
+
+    QFile file(cacheDir + '/' + IndexFileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+
+    const QJsonObject sourceObject = root.value("sources").toObject();
+    for (auto it = sourceObject.constBegin(); it != sourceObject.constEnd(); ++it) {
+        const QJsonObject o = it.value().toObject();
+        SourceRecord record;
+        record.size = o.value("size").toVariant().toLongLong();
+        record.modified = o.value("modified").toVariant().toLongLong();
+        record.hash = o.value("hash").toString().toLatin1();
+        sources.insert(it.key(), record);
+    }
+
+    const QJsonObject entryObject = root.value("entries").toObject();
+    for (auto it = entryObject.constBegin(); it != entryObject.constEnd(); ++it) {
+        const QJsonObject o = it.value().toObject();
+        EntryRecord record;
+        record.bytes = o.value("bytes").toVariant().toLongLong();
+        record.lastUsed = o.value("lastUsed").toVariant().toLongLong();
+        record.hash = o.value("hash").toString().toLatin1();
+        // Entries from before the index recorded their source cannot be pruned with it
+        if (record.hash.isEmpty()) {
+            QFile::remove(entryPath(it.key()));
+            indexDirty = true;
+            continue;
+        }
+        entries.insert(it.key(), record);
+        totalBytes += record.bytes;
+    }
+}
+
+/**
+ * @brief Writes the path and entry records. Mutex must be held.
+ */
+void GeometryCache::saveIndex() {
+    if (!enabled)
+        return;
+
+    QJsonObject sourceObject;
+    for (auto it = sources.constBegin(); it != sources.constEnd(); ++it) {
+        QJsonObject o;
+        o.insert("size", QString::number(it->size));
+        o.insert("modified", QString::number(it->modified));
+        o.insert("hash", QString::fromLatin1(it->hash));
+        sourceObject.insert(it.key(), o);
+    }
+
+    QJsonObject entryObject;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        QJsonObject o;
+        o.insert("bytes", QString::number(it->bytes));
+        o.insert("lastUsed", QString::number(it->lastUsed));
+        o.insert("hash", QString::fromLatin1(it->hash));
+        entryObject.insert(it.key(), o);
+    }
+
+    QJsonObject root;
+    root.insert("sources", sourceObject);
+    root.insert("entries", entryObject);
+
+    QSaveFile file(cacheDir + '/' + IndexFileName);
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
@@ -0,0 +1,182 @@
+#ifndef GEOMETRY_CACHE_H
+#define GEOMETRY_CACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QtGlobal>
+
+#include <atomic>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file
+ * This file contains the declaration of the GeometryCache class, an on-disk
+ * cache of processed STL geometry.
+ */
+
+ /**
+  * @class GeometryCache
+  * @brief Stores parsed, welded and normal-computed geometry so STL files only need parsing once.
+  *
+  * Entries are keyed by a hash of the STL file's contents, so renamed or copied files
+  * still hit. A small index maps each path, size and modification time to its content
+  * hash, so a warm lookup only needs to stat the file. A file seen for the first time
+  * is hashed by the reader while it is parsed, so it is only read once.
+  *
+  * Changes to the index are kept in memory and written by flush(), once per batch
+  * of loads, rather than on every lookup.
+  *
+  * Each entry is one flat binary file: a fixed header followed by 8-byte aligned
+  * point, normal, offset and connectivity arrays. It is memory mapped and copied into
+  * VTK arrays in bulk. The total size on disk is capped, with the least recently used
+  * entries evicted first.
+  *
+  * All functions are thread safe, so loader workers can share the instance.
+  */
+class GeometryCache {
+public:
+    /**
+     * @brief Returns the cache shared by the whole application.
+     */
+    static GeometryCache& instance();
+
+    /**
+     * @brief Sets the directory entries are stored in, creating it if needed.
+     */
+    void setDirectory(const QString& path);
+
+    /**
+     * @brief Returns the directory entries are stored in.
+     */
+    QString directory() const;
+
+    /**
+     * @brief Sets the maximum total size of the cache on disk and evicts down to it.
+     */
+    void setMaxBytes(qint64 bytes);
+
+    /**
+     * @brief Returns the maximum total size of the cache on disk.
+     */
+    qint64 maxBytes() const;
+
+    /**
+     * @brief Returns the total size of all entries on disk.
+     */
+    qint64 bytesOnDisk() const;
+
+    /**
+     * @brief Enables or disables lookups and stores.
+     */
+    void setEnabled(bool enabled);
+
+    /**
+     * @brief Returns whether the cache is in use.
+     */
+    bool isEnabled() const;
+
+    /**
+     * @brief Returns a hash of a file's contents, reusing the stored hash if the file has not changed.
+     *
+     * Reads the whole file when its hash is not known. Readers that go through the
+     * file anyway should use knownHash() and recordHash() instead.
+     * @param fileName Path to the file.
+     * @return Hex encoded hash, or an empty array if the file cannot be read.
+     */
+    QByteArray contentHash(const QString& fileName);
+
+    /**
+     * @brief Returns the stored hash of a file if its size and modification time are unchanged.
+     *
+     * Only stats the file.
+     * @return Hex encoded hash, or an empty array if the file has not been hashed before.
+     */
+    QByteArray knownHash(const QString& fileName);
+
+    /**
+     * @brief Records the hash of a file computed by its reader.
+     * @param fileName Path to the file.
+     * @param hash Hex encoded MD5 of the file's contents.
+     */
+    void recordHash(const QString& fileName, const QByteArray& hash);
+
+    /**
+     * @brief Loads processed geometry if it is cached.
+     * @param hash Content hash of the STL file.
+     * @param weldTolerance Weld tolerance the geometry was processed with.
+     * @return The cached geometry, or nullptr on a miss.
+     */
+    vtkSmartPointer<vtkPolyData> load(const QByteArray& hash, double weldTolerance);
+
+    /**
+     * @brief Stores processed geometry and evicts old entries if over the cap.
+     * @param hash Content hash of the STL file.
+     * @param weldTolerance Weld tolerance the geometry was processed with.
+     * @param data The processed geometry. Only points, point normals and polygons are stored.
+     */
+    void store(const QByteArray& hash, double weldTolerance, vtkPolyData* data);
+
+    /**
+     * @brief Writes the index if it changed since the last flush.
+     */
+    void flush();
+
+    /**
+     * @brief Returns the number of lookups that found an entry.
+     */
+    quint64 hits() const { return hitCount; }
+
+    /**
+     * @brief Returns the number of lookups that did not find an entry.
+     */
+    quint64 misses() const { return missCount; }
+
+private:
+    GeometryCache();
+    ~GeometryCache();
+    GeometryCache(const GeometryCache&) = delete;
+    GeometryCache& operator=(const GeometryCache&) = delete;
+
+    /**
+     * @brief Hash recorded for a path at a given size and modification time.
+     */
+    struct SourceRecord {
+        qint64 size = 0;
+        qint64 modified = 0;
+        QByteArray hash;
+    };
+
+    /**
+     * @brief Size and last use time of an entry on disk.
+     */
+    struct EntryRecord {
+        qint64 bytes = 0;
+        qint64 lastUsed = 0;
+        QByteArray hash;    /**< Content hash the entry was made from */
+    };
+
+    QString entryName(const QByteArray& hash, double weldTolerance) const;
+    QString entryPath(const QString& name) const;
+    void loadIndex();
+    void saveIndex();
+    void evict();
+    void pruneSources();
+
+    mutable QMutex mutex;                   /**< Guards everything below */
+    QString cacheDir;                       /**< Directory holding the entries and index */
+    qint64 maxCacheBytes;                   /**< Size cap for all entries */
+    qint64 totalBytes = 0;                  /**< Current size of all entries */
+    bool enabled = true;                    /**< Whether lookups and stores happen */
+    bool indexDirty = false;                /**< Index changed since it was last written */
+    QHash<QString, SourceRecord> sources;   /**< STL path to content hash */
+    QHash<QString, EntryRecord> entries;    /**< Entry name to size and last use */
+
+    std::atomic<quint64> hitCount{ 0 };     /**< Lookups that found an entry */
+    std::atomic<quint64> missCount{ 0 };    /**< Lookups that did not find an entry */
+};
+
+#endif // GEOMETRY_CACHE_H
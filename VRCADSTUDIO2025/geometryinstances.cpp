@@ -0,0 +1,116 @@
+#include "geometryinstances.h"
+
+#include <chrono>
+
+GeometryInstances& GeometryInstances::instance() {
+    static GeometryInstances instances;
+    return instances;
+}
+
+/**
+ * @brief Looks up the key, or publishes a pending result for it and runs the load.
+ *
+ * The load itself runs without the lock held, so different keys load in parallel.
+ */
+vtkSmartPointer<vtkPolyData> GeometryInstances::acquire(const QByteArray& key, const std::function<vtkSmartPointer<vtkPolyData>()>& load) {
+    if (key.isEmpty())
+        return load();
+
+    std::promise<vtkSmartPointer<vtkPolyData>> promise;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = entries.constFind(key);
+        if (it != entries.constEnd()) {
+            Result result = it.value();
+            locker.unlock();
+
+            vtkSmartPointer<vtkPolyData> data = result.get();
+            if (data)
+                shared++;
+            return data;
+        }
+        entries.insert(key, promise.get_future().share());
+    }
+
+    vtkSmartPointer<vtkPolyData> data = load();
+    promise.set_value(data);
+
+    if (!data) {
+        QMutexLocker locker(&mutex);
+        entries.remove(key);
+    }
+    return data;
+}
+
+vtkSmartPointer<vtkPolyData> GeometryInstances::adopt(const QByteArray& key, vtkPolyData* data) {
+    if (key.isEmpty() || !data)
+        return data;
+
+    Result result;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = entries.constFind(key);
+        if (it == entries.constEnd()) {
+            std::promise<vtkSmartPointer<vtkPolyData>> promise;
+            promise.set_value(data);
+            entries.insert(key, promise.get_future().share());
+            return data;
+        }
+        result = it.value();
+    }
+
+    vtkSmartPointer<vtkPolyData> existing = result.get();
+    if (!existing)
+        return data;
+    shared++;
+    return existing;
+}
+
+vtkSmartPointer<vtkPolyDataMapper> GeometryInstances::mapperFor(vtkPolyData* data) {
+    vtkSmartPointer<vtkPolyDataMapper> mapper = mappers.value(data);
+
+    // The weak pointer is cleared once the last part drops the mapper, and a mapper
+    // always holds its input, so a live mapper is always showing this geometry
+    if (!mapper) {
+        mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+        mapper->SetInputData(data);
+        mappers.insert(data, mapper);
+    }
+    return mapper;
+}
+
+/**
+ * @brief Releases entries that only this registry still references.
+ */
+int GeometryInstances::purge() {
+    for (auto it = mappers.begin(); it != mappers.end();) {
+        if (!it.value())
+            it = mappers.erase(it);
+        else
+            ++it;
+    }
+
+    QMutexLocker locker(&mutex);
+    int released = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+        const Result& result = it.value();
+        const bool ready = result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        if (ready && result.get() && result.get()->GetReferenceCount() == 1) {
+            it = entries.erase(it);
+            released++;
+        }
+        else {
+            ++it;
+        }
+    }
+    return released;
+}
+
+int GeometryInstances::uniqueCount() const {
+    QMutexLocker locker(&mutex);
+    return entries.size();
+}
+
+quint64 GeometryInstances::sharedCount() const {
+    return shared;
+}
@@ -0,0 +1,96 @@
+#ifndef GEOMETRY_INSTANCES_H
+#define GEOMETRY_INSTANCES_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+
+#include <atomic>
+#include <functional>
+#include <future>
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkPolyData.h>
+#include <vtkPolyDataMapper.h>
+
+/**
+ * @file
+ * This file contains the declaration of the GeometryInstances class, which lets
+ * parts loaded from identical files share one copy of their geometry.
+ */
+
+ /**
+  * @class GeometryInstances
+  * @brief Shares geometry and mappers between parts with identical content.
+  *
+  * Geometry is keyed by a hash of the source file's contents, so the same fastener
+  * loaded a hundred times is parsed once and held in memory once. Shared geometry is
+  * never modified; parts that filter it run the filters on their own shallow copy.
+  *
+  * Parts showing the same geometry also share one mapper, so it is uploaded to the
+  * GPU once. Each part keeps its own actor for its transform, colour and visibility.
+  */
+class GeometryInstances {
+public:
+    /**
+     * @brief Returns the registry shared by the whole application.
+     */
+    static GeometryInstances& instance();
+
+    /**
+     * @brief Returns the geometry for a key, calling load only if no other caller has.
+     *
+     * Concurrent callers with the same key wait for the first one's result rather than
+     * loading again. Thread safe. Failed loads are not remembered.
+     * @param key Content key, e.g. a file hash. Empty keys are never shared.
+     * @param load Produces the geometry on a miss.
+     * @return The shared geometry, or nullptr if load failed.
+     */
+    vtkSmartPointer<vtkPolyData> acquire(const QByteArray& key, const std::function<vtkSmartPointer<vtkPolyData>()>& load);
+
+    /**
+     * @brief Registers geometry that was loaded before its key was known.
+     *
+     * Used when the key is computed while loading. If another caller already holds
+     * geometry for the key, that is returned instead and the new copy can be dropped.
+     * Thread safe.
+     * @param key Content key. Empty keys are never shared.
+     * @param data The loaded geometry.
+     * @return The shared geometry for the key.
+     */
+    vtkSmartPointer<vtkPolyData> adopt(const QByteArray& key, vtkPolyData* data);
+
+    /**
+     * @brief Returns the mapper shared by every part showing this geometry. GUI thread only.
+     */
+    vtkSmartPointer<vtkPolyDataMapper> mapperFor(vtkPolyData* data);
+
+    /**
+     * @brief Drops geometry that no part uses any more. GUI thread only.
+     * @return The number of entries released.
+     */
+    int purge();
+
+    /**
+     * @brief Returns the number of distinct geometries held.
+     */
+    int uniqueCount() const;
+
+    /**
+     * @brief Returns how many acquire() or adopt() calls were served by existing geometry.
+     */
+    quint64 sharedCount() const;
+
+private:
+    GeometryInstances() = default;
+
+    using Result = std::shared_future<vtkSmartPointer<vtkPolyData>>;
+
+    mutable QMutex mutex;                        /**< Guards entries */
+    QHash<QByteArray, Result> entries;           /**< Geometry, or a load in progress, per key */
+    QHash<vtkPolyData*, vtkWeakPointer<vtkPolyDataMapper>> mappers; /**< Shared mapper per geometry */
+    std::atomic<quint64> shared{ 0 };            /**< Number of calls that reused geometry */
+};
+
+#endif // GEOMETRY_INSTANCES_H
@@ -0,0 +1,31 @@
+#include "geometrysnapshot.h"
+
+#include <atomic>
+
+#include <vtkPoints.h>
+
+GeometrySnapshot::Ptr GeometrySnapshot::create(vtkPolyData* data) {
+    static std::atomic<quint64> nextSerial{ 1 };
+
+    std::shared_ptr<GeometrySnapshot> snapshot(new GeometrySnapshot());
+    snapshot->serial = nextSerial++;
+    snapshot->geometry = vtkSmartPointer<vtkPolyData>::New();
+    if (data)
+        snapshot->geometry->ShallowCopy(data);
+
+    // Bounds are cached in the shared vtkPoints on first use. Computing them here,
+    // before any other thread sees the points, means views only ever read the cache
+    snapshot->geometry->GetBounds(snapshot->geometryBounds);
+    if (vtkPoints* points = snapshot->geometry->GetPoints())
+        points->GetBounds();
+
+    snapshot->points = snapshot->geometry->GetNumberOfPoints();
+    snapshot->cells = snapshot->geometry->GetNumberOfCells();
+    return snapshot;
+}
+
+vtkSmartPointer<vtkPolyData> GeometrySnapshot::view() const {
+    vtkSmartPointer<vtkPolyData> view = vtkSmartPointer<vtkPolyData>::New();
+    view->ShallowCopy(geometry);
+    return view;
+}
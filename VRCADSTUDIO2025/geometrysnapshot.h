@@ -0,0 +1,73 @@
+#ifndef GEOMETRY_SNAPSHOT_H
+#define GEOMETRY_SNAPSHOT_H
+
+#include <QtGlobal>
+
+#include <memory>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file
+ * This file contains the declaration of the GeometrySnapshot class, the immutable
+ * geometry a ModelPart publishes for the renderers on other threads.
+ */
+
+ /**
+  * @class GeometrySnapshot
+  * @brief Immutable, reference-counted geometry shared between threads without copying.
+  *
+  * VTK objects may not be used by two threads at once: even drawing a mesh writes
+  * pipeline information and cached bounds into it. A snapshot holds a private poly
+  * data that no pipeline is ever connected to, so any thread may read it. Each
+  * renderer draws its own view(), which shares every array with the snapshot and so
+  * costs a few hundred bytes whatever the size of the mesh.
+  *
+  * Snapshots are never modified. A part that changes its geometry publishes a new
+  * one; renderers holding the old one keep drawing it until they pick up the new one.
+  */
+class GeometrySnapshot {
+public:
+    using Ptr = std::shared_ptr<const GeometrySnapshot>;
+
+    /**
+     * @brief Takes a snapshot of geometry that will not be modified again.
+     *
+     * Call on the thread that owns data. The arrays are shared, not copied.
+     * @param data Geometry to publish; nullptr gives an empty snapshot.
+     */
+    static Ptr create(vtkPolyData* data);
+
+    /**
+     * @brief Returns new poly data sharing the snapshot's arrays, for one consumer.
+     *
+     * Thread safe. The view belongs to the caller, who may connect it to a mapper.
+     */
+    vtkSmartPointer<vtkPolyData> view() const;
+
+    /**
+     * @brief Returns the bounds of the geometry, computed when the snapshot was taken.
+     */
+    const double* bounds() const { return geometryBounds; }
+
+    vtkIdType numberOfPoints() const { return points; }
+    vtkIdType numberOfCells() const { return cells; }
+
+    /**
+     * @brief Returns a number that increases with every snapshot taken, so consumers
+     * can tell whether they already show this one.
+     */
+    quint64 version() const { return serial; }
+
+private:
+    GeometrySnapshot() = default;
+
+    vtkSmartPointer<vtkPolyData> geometry;       /**< Private copy sharing the published arrays */
+    double geometryBounds[6] = { 0, -1, 0, -1, 0, -1 };  /**< Bounds, invalid if empty */
+    vtkIdType points = 0;                        /**< Number of points */
+    vtkIdType cells = 0;                         /**< Number of cells */
+    quint64 serial = 0;                          /**< Order in which snapshots were taken */
+};
+
+#endif // GEOMETRY_SNAPSHOT_H
@@ -0,0 +1,333 @@
+#include "headless.h"
+#include "ModelPart.h"
+#include "ModelPartList.h"
+#include "assemblyfilter.h"
+#include "vrrenderthread.h"
+#include "simulatedhmd.h"
+#include "geometrycache.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkCamera.h>
+#include <vtkTransform.h>
+#include <vtkLight.h>
+#include <vtkWindowToImageFilter.h>
+#include <vtkPNGWriter.h>
+
+bool IsHeadlessRequested(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0)
+            return true;
+    }
+    return false;
+}
+
+bool ParseHeadlessArguments(const QCoreApplication& app, HeadlessOptions& options) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders STL assemblies offscreen to a PNG.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("files", "STL files to load.", "files...");
+
+    QCommandLineOption headless("headless", "Run without a window.");
+    QCommandLineOption output({ "o", "output" }, "PNG file to write.", "file", options.output);
+    QCommandLineOption size("size", "Image size.", "WxH", QString("%1x%2").arg(options.width).arg(options.height));
+    QCommandLineOption clip("clip", "Apply the clip filter to every part.");
+    QCommandLineOption shrink("shrink", "Apply the shrink filter to every part.");
+    QCommandLineOption shrinkFactor("shrink-factor", "Shrink factor.", "factor", QString::number(options.shrinkFactor));
+    QCommandLineOption azimuth("azimuth", "Camera azimuth in degrees.", "degrees", QString::number(options.azimuth));
+    QCommandLineOption elevation("elevation", "Camera elevation in degrees.", "degrees", QString::number(options.elevation));
+    QCommandLineOption frames("frames", "Frames to render for timing.", "count", QString::number(options.frames));
+    QCommandLineOption backend("backend", "Offscreen OpenGL: egl or osmesa. Needs a VTK built with it.", "name");
+    QCommandLineOption vr("vr", "Also run the VR thread on a simulated headset.", "seconds");
+    QCommandLineOption vrPoses("vr-poses", "Head motion of the simulated headset: orbit, sweep or static.", "name", options.vrPoses);
+    QCommandLineOption vrRecord("vr-record", "Record the simulated VR session to a log.", "file");
+    QCommandLineOption vrReplay("vr-replay", "Replay a recorded VR session on the simulated headset.", "file");
+    QCommandLineOption vrTimings("vr-timings", "Write the per-frame timing of a replay to a CSV file.", "file");
+    parser.addOptions({ headless, output, size, clip, shrink, shrinkFactor, azimuth, elevation, frames, backend,
+                        vr, vrPoses, vrRecord, vrReplay, vrTimings });
+
+    parser.process(app);
+
+    QTextStream err(stderr);
+    options.files = parser.positionalArguments();
+    if (options.files.isEmpty()) {
+        err << "No STL files given\n";
+        return false;
+    }
+
+    const QStringList dimensions = parser.value(size).split('x');
+    bool okWidth = false, okHeight = false;
+    if (dimensions.size() == 2) {
+        options.width = dimensions[0].toInt(&okWidth);
+        options.height = dimensions[1].toInt(&okHeight);
+    }
+    if (!okWidth || !okHeight || options.width <= 0 || options.height <= 0) {
+        err << "Invalid size " << parser.value(size) << ", expected WxH\n";
+        return false;
+    }
+
+    options.output = parser.value(output);
+    options.clip = parser.isSet(clip);
+    options.shrink = parser.isSet(shrink);
+    options.shrinkFactor = parser.value(shrinkFactor).toDouble();
+    options.azimuth = parser.value(azimuth).toDouble();
+    options.elevation = parser.value(elevation).toDouble();
+    options.frames = std::max(1, parser.value(frames).toInt());
+    options.vrSeconds = std::max(0.0, parser.value(vr).toDouble());
+    options.vrPoses = parser.value(vrPoses);
+    options.vrRecord = parser.value(vrRecord);
+    options.vrReplay = parser.value(vrReplay);
+    options.vrTimings = parser.value(vrTimings);
+
+    const QString name = parser.value(backend).toLower();
+    if (name == "egl")
+        options.backend = "vtkEGLRenderWindow";
+    else if (name == "osmesa")
+        options.backend = "vtkOSOpenGLRenderWindow";
+    else if (!name.isEmpty()) {
+        err << "Unknown backend " << name << ", expected egl or osmesa\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Sends a part and its children to the VR thread the way MainWindow does,
+ * so a recorded session's commands find the same parts on replay.
+ */
+static void SendPartToVR(VRRenderThread& thread, ModelPart* part) {
+    thread.setNodeTransform(reinterpret_cast<quintptr>(part), reinterpret_cast<quintptr>(part->parentItem()),
+                            part->getLocalTransform()->GetMatrix());
+    if (part->getActor()) {
+        vtkSmartPointer<vtkActor> actor = part->getNewActor();
+        if (actor)
+            thread.addActor(reinterpret_cast<quintptr>(part), actor);
+    }
+    for (int i = 0; i < part->childCount(); ++i)
+        SendPartToVR(thread, part->child(i));
+}
+
+/**
+ * @brief Writes the recorded and replayed timing of every frame of a replay.
+ */
+static bool WriteReplayTimings(const QString& fileName, const VRSessionLog& log, const std::vector<VRSessionFrame>& replayed) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream csv(&file);
+    csv << "frame,time_ms,recorded_interval_ms,replay_interval_ms,recorded_render_ms,replay_render_ms\n";
+    for (size_t i = 0; i < replayed.size() && i < log.frames.size(); ++i) {
+        const VRSessionFrame& recorded = log.frames[i];
+        csv << replayed[i].frame << ',' << recorded.timeNs / 1e6 << ',' << recorded.intervalMs << ','
+            << replayed[i].intervalMs << ',' << recorded.renderMs << ',' << replayed[i].renderMs << '\n';
+    }
+    return true;
+}
+
+/**
+ * @brief Runs the VR render thread on a simulated headset for the requested time,
+ * or through a recorded session, and prints its frame timing, so VR performance can
+ * be measured without a headset.
+ */
+static int RunSimulatedVR(ModelPart* module, const HeadlessOptions& options, QTextStream& out) {
+    QTextStream err(stderr);
+
+    SimulatedHMDBackend* backend = new SimulatedHMDBackend();
+    VRRenderThread thread;
+    thread.setBackend(backend);
+
+    VRSessionLog log;
+    if (!options.vrReplay.isEmpty()) {
+        QString error;
+        if (!log.load(options.vrReplay, &error)) {
+            err << error << "\n";
+            return 1;
+        }
+        backend->setFramePoses(log.headPoses());
+        backend->setDisplayRate(log.displayRate);
+        thread.replaySession(&log);
+    }
+    else {
+        backend->setPoseScript(SimulatedHMDBackend::script(options.vrPoses));
+        backend->setDuration(options.vrSeconds);
+    }
+    if (!options.vrRecord.isEmpty())
+        thread.recordSession(options.vrRecord);
+
+    SendPartToVR(thread, module);
+
+    thread.start();
+    thread.wait();
+
+    const VRFrameStats stats = thread.frameStats();
+    if (stats.frames == 0) {
+        err << "The simulated headset could not render\n";
+        return 1;
+    }
+
+    const QString session = options.vrReplay.isEmpty() ? options.vrPoses : options.vrReplay;
+    out << "vr frames:    " << stats.frames << " (" << session << ", "
+        << QString::number(1000.0 / stats.targetFrameMs, 'f', 0) << " Hz)\n"
+        << "vr frame:     " << QString::number(stats.meanFrameMs, 'f', 2) << " ms mean, "
+        << QString::number(stats.maxFrameMs, 'f', 2) << " ms max, "
+        << QString::number(stats.meanCpuMs, 'f', 2) << " ms cpu\n"
+        << "vr dropped:   " << stats.droppedFrames << "\n";
+
+    if (!options.vrReplay.isEmpty()) {
+        double recordedMean = 0;
+        for (const VRSessionFrame& frame : log.frames)
+            recordedMean += frame.intervalMs;
+        recordedMean /= log.frames.size();
+        out << "vr recorded:  " << QString::number(recordedMean, 'f', 2) << " ms mean over "
+            << log.frames.size() << " frames\n";
+    }
+    if (!options.vrTimings.isEmpty() && !WriteReplayTimings(options.vrTimings, log, thread.replayFrames())) {
+        err << "Could not write " << options.vrTimings << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Parses the files on a thread pool like STLLoader, but waits for them instead
+ * of delivering through the event loop.
+ */
+int RunHeadless(const HeadlessOptions& options) {
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    QElapsedTimer timer;
+
+    ModelPartList partList("PartsList");
+    ModelPart* module = new ModelPart({ "Module", "true" });
+    partList.getRootItem()->appendChild(module);
+
+    // Load
+    timer.start();
+    std::vector<vtkSmartPointer<vtkPolyData>> data(options.files.size());
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(QThread::idealThreadCount());
+        for (int i = 0; i < options.files.size(); ++i) {
+            const QString fileName = options.files.at(i);
+            pool.start([&data, fileName, i]() {
+                data[i] = ModelPart::readSTL(fileName);
+            });
+        }
+        pool.waitForDone();
+    }
+    GeometryCache::instance().flush();
+
+    vtkIdType triangles = 0;
+    for (int i = 0; i < options.files.size(); ++i) {
+        if (!data[i]) {
+            err << "Could not load " << options.files.at(i) << "\n";
+            continue;
+        }
+        ModelPart* part = new ModelPart({ QFileInfo(options.files.at(i)).fileName(), "true" });
+        module->appendChild(part);
+        part->setPolyData(options.files.at(i), data[i]);
+        triangles += data[i]->GetNumberOfPolys();
+    }
+    const double loadMs = timer.nsecsElapsed() / 1e6;
+    if (module->childCount() == 0) {
+        err << "No files could be loaded\n";
+        return 1;
+    }
+
+    // Filter, with the same settings the GUI checkboxes use
+    timer.start();
+    if (options.clip) {
+        double origin[3] = { 0.0, 0.0, 0.0 };
+        double normal[3] = { 0.0, -1.0, 0.0 };
+        ApplyClipFilterToSubtree(module, true, origin, normal);
+    }
+    if (options.shrink)
+        ApplyShrinkFilterToSubtree(module, true, options.shrinkFactor);
+    const double filterMs = timer.nsecsElapsed() / 1e6;
+
+    // Render offscreen. The factory picks the window class, which can be overridden
+    // at run time in VTK builds with more than one OpenGL backend
+    if (!options.backend.isEmpty())
+        qputenv("VTK_DEFAULT_OPENGL_WINDOW", options.backend.toLatin1());
+
+    vtkNew<vtkRenderer> renderer;
+    renderer->SetBackground(0, 0, 0);
+
+    vtkNew<vtkLight> light;
+    light->SetLightTypeToSceneLight();
+    light->SetPosition(0, 0, 1);
+    light->SetFocalPoint(0, 0, 0);
+    light->SetIntensity(0.5);
+    renderer->AddLight(light);
+
+    for (int i = 0; i < module->childCount(); ++i)
+        renderer->AddActor(module->child(i)->getActor());
+
+    renderer->ResetCamera();
+    renderer->GetActiveCamera()->Azimuth(options.azimuth);
+    renderer->GetActiveCamera()->Elevation(options.elevation);
+    renderer->ResetCameraClippingRange();
+
+    vtkNew<vtkRenderWindow> window;
+    window->SetOffScreenRendering(1);
+    window->SetSize(options.width, options.height);
+    window->AddRenderer(renderer);
+
+    // The first frame includes context creation and uploading the geometry
+    timer.start();
+    window->Render();
+    const double firstFrameMs = timer.nsecsElapsed() / 1e6;
+
+    timer.start();
+    for (int i = 1; i < options.frames; ++i)
+        window->Render();
+    const double frameMs = options.frames > 1 ? timer.nsecsElapsed() / 1e6 / (options.frames - 1) : firstFrameMs;
+
+    timer.start();
+    vtkNew<vtkWindowToImageFilter> capture;
+    capture->SetInput(window);
+    capture->SetInputBufferTypeToRGB();
+    capture->ReadFrontBufferOff();
+
+    vtkNew<vtkPNGWriter> writer;
+    writer->SetFileName(options.output.toLocal8Bit().constData());
+    writer->SetInputConnection(capture->GetOutputPort());
+    writer->Write();
+    const double writeMs = timer.nsecsElapsed() / 1e6;
+
+    if (writer->GetErrorCode() != 0) {
+        err << "Could not write " << options.output << "\n";
+        return 1;
+    }
+
+    out << "window:       " << window->GetClassName() << "\n"
+        << "parts:        " << module->childCount() << " of " << options.files.size()
+        << " (" << triangles << " triangles)\n"
+        << "load:         " << QString::number(loadMs, 'f', 2) << " ms\n"
+        << "filter:       " << QString::number(filterMs, 'f', 2) << " ms\n"
+        << "first frame:  " << QString::number(firstFrameMs, 'f', 2) << " ms\n"
+        << "frame:        " << QString::number(frameMs, 'f', 2) << " ms (" << options.frames << " frames)\n"
+        << "write png:    " << QString::number(writeMs, 'f', 2) << " ms\n"
+        << "output:       " << options.output << " (" << options.width << "x" << options.height << ")\n";
+
+    if (options.vrSeconds > 0 || !options.vrReplay.isEmpty())
+        return RunSimulatedVR(module, options, out);
+    return 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+
+class QCoreApplication;
+
+/**
+ * @file
+ * This file contains the headless batch mode, which loads STL files into a model tree,
+ * applies filters and renders the result offscreen to a PNG without any window or GPU.
+ */
+
+/**
+ * @brief Settings for one headless run, taken from the command line.
+ */
+struct HeadlessOptions {
+    QStringList files;              /**< STL files to load */
+    QString output = "render.png";  /**< PNG to write */
+    int width = 1920;               /**< Image width in pixels */
+    int height = 1080;              /**< Image height in pixels */
+    bool clip = false;              /**< Apply the clip filter to every part */
+    bool shrink = false;            /**< Apply the shrink filter to every part */
+    double shrinkFactor = 0.8;      /**< Shrink factor when shrink is on */
+    double azimuth = 30.0;          /**< Camera azimuth in degrees, as in the GUI */
+    double elevation = 30.0;        /**< Camera elevation in degrees, as in the GUI */
+    int frames = 1;                 /**< Frames to render for timing; the last is saved */
+    QString backend;                /**< Offscreen OpenGL window class, empty for VTK's default */
+    double vrSeconds = 0.0;         /**< Run the VR thread on a simulated headset this long, zero to skip */
+    QString vrPoses = "orbit";      /**< Head motion of the simulated headset */
+    QString vrRecord;               /**< Session log to record the simulated VR run to */
+    QString vrReplay;               /**< Session log to replay on the simulated headset */
+    QString vrTimings;              /**< CSV to write the per-frame timing of a replay to */
+};
+
+/**
+ * @brief Returns whether the command line asks for headless mode.
+ *
+ * Checked before any QApplication exists, since a GUI application needs a display.
+ */
+bool IsHeadlessRequested(int argc, char* argv[]);
+
+/**
+ * @brief Reads the headless options from the application's command line.
+ * @param app The running application.
+ * @param options Filled in from the arguments.
+ * @return false if the arguments are invalid; the reason has been printed.
+ */
+bool ParseHeadlessArguments(const QCoreApplication& app, HeadlessOptions& options);
+
+/**
+ * @brief Loads, filters and renders the files offscreen, printing the time each stage took.
+ * @param options What to load and how to render it.
+ * @return Process exit code, 0 on success.
+ */
+int RunHeadless(const HeadlessOptions& options);
@@ -0,0 +1,214 @@
+#include "levelofdetail.h"
+#include "ModelPart.h"
+#include "profiler.h"
+
+#include <QThread>
+
+#include <vtkNew.h>
+#include <vtkQuadricDecimation.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkCamera.h>
+#include <vtkActor.h>
+#include <vtkMath.h>
+#include <vtkPolyDataMapper.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // On-screen height in pixels at or above which each level is used, finest first
+    const double LevelThresholds[] = { 400.0, 150.0, 50.0 };
+}
+
+/**
+ * @brief Decimates each level from the previous one and gives it point normals.
+ */
+std::vector<vtkSmartPointer<vtkPolyData>> BuildLevelsOfDetail(vtkPolyData* input, const std::vector<double>& fractions) {
+    std::vector<vtkSmartPointer<vtkPolyData>> levels;
+
+    vtkSmartPointer<vtkPolyData> previous = input;
+    double previousFraction = 1.0;
+
+    for (double fraction : fractions) {
+        vtkNew<vtkQuadricDecimation> decimate;
+        decimate->SetInputData(previous);
+        decimate->SetTargetReduction(1.0 - fraction / previousFraction);
+        decimate->VolumePreservationOn();
+
+        vtkNew<vtkPolyDataNormals> normals;
+        normals->SetInputConnection(decimate->GetOutputPort());
+        normals->ConsistencyOff();
+        normals->SplittingOn();
+        normals->Update();
+
+        vtkSmartPointer<vtkPolyData> level = vtkSmartPointer<vtkPolyData>::New();
+        level->ShallowCopy(normals->GetOutput());
+        levels.push_back(level);
+
+        previous = level;
+        previousFraction = fraction;
+    }
+
+    return levels;
+}
+
+/**
+ * @brief Projects each part's bounding sphere to the viewport and picks a level from its size.
+ */
+void SelectLevelsOfDetail(vtkRenderer* renderer, const QSet<ModelPart*>& parts, double bias) {
+    vtkCamera* camera = renderer->GetActiveCamera();
+    const int* size = renderer->GetSize();
+    if (!camera || size[1] <= 0)
+        return;
+
+    double eye[3];
+    camera->GetPosition(eye);
+    const double halfHeight = size[1] * 0.5;
+    const double tanHalfAngle = std::tan(camera->GetViewAngle() * 0.5 * vtkMath::Pi() / 180.0);
+    const bool parallel = camera->GetParallelProjection() != 0;
+    const double parallelScale = camera->GetParallelScale();
+
+    for (ModelPart* part : parts) {
+        vtkActor* actor = part->getActor();
+        if (actor && part->lodLevelCount() > 1 && part->visible()) {
+            double bounds[6];
+            actor->GetBounds(bounds);
+
+            const double dx = bounds[1] - bounds[0];
+            const double dy = bounds[3] - bounds[2];
+            const double dz = bounds[5] - bounds[4];
+            const double radius = 0.5 * std::sqrt(dx * dx + dy * dy + dz * dz);
+            const double center[3] = { (bounds[0] + bounds[1]) * 0.5, (bounds[2] + bounds[3]) * 0.5, (bounds[4] + bounds[5]) * 0.5 };
+
+            double pixels;
+            if (parallel) {
+                pixels = parallelScale > 0.0 ? radius / parallelScale * halfHeight : 0.0;
+            }
+            else {
+                const double distance = std::sqrt(vtkMath::Distance2BetweenPoints(eye, center));
+                pixels = distance > radius ? radius / (distance * tanHalfAngle) * halfHeight : size[1];
+            }
+            pixels /= bias;
+
+            int level = 0;
+            for (double threshold : LevelThresholds) {
+                if (pixels >= threshold)
+                    break;
+                level++;
+            }
+            part->selectLOD(std::min(level, part->lodLevelCount() - 1));
+        }
+    }
+}
+
+/**
+ * @brief Constructs the builder. Half the cores are used so decimation never starves loading.
+ */
+LODBuilder::LODBuilder(QObject* parent)
+    : QObject(parent)
+{
+    pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+}
+
+LODBuilder::~LODBuilder() {
+    pool.clear();
+    pool.waitForDone();
+}
+
+/**
+ * @brief Hands a part the levels of its geometry, building them on the pool if needed.
+ *
+ * Levels are kept per geometry, so instances of the same part are decimated once and
+ * share their mappers.
+ */
+void LODBuilder::build(ModelPart* part) {
+    vtkPolyData* original = part->getOriginalPolyData();
+    if (!original || original->GetNumberOfPolys() < MinLODTriangles)
+        return;
+
+    auto it = entries.find(original);
+    if (it != entries.end() && it->source == original) {
+        if (it->building) {
+            if (!it->waiting.contains(part))
+                it->waiting.append(part);
+            return;
+        }
+
+        std::vector<vtkSmartPointer<vtkPolyDataMapper>> mappers(it->mappers.begin(), it->mappers.end());
+        if (std::all_of(mappers.begin(), mappers.end(), [](const auto& mapper) { return mapper != nullptr; })) {
+            part->setLODMappers(mappers);
+            detailed.insert(part);
+            emit lodReady(part);
+            return;
+        }
+    }
+
+    // Forget geometry that has been deleted since its levels were built
+    for (auto stale = entries.begin(); stale != entries.end();) {
+        if (!stale->source)
+            stale = entries.erase(stale);
+        else
+            ++stale;
+    }
+
+    // Build the cell structure here so the worker only ever reads the shared arrays
+    if (original->NeedToBuildCells())
+        original->BuildCells();
+
+    vtkSmartPointer<vtkPolyData> input = vtkSmartPointer<vtkPolyData>::New();
+    input->ShallowCopy(original);
+
+    Entry& entry = entries[original];
+    entry.source = original;
+    entry.ticket = ++nextTicket;
+    entry.building = true;
+    entry.waiting = { part };
+    entry.mappers.clear();
+
+    const quint64 ticket = entry.ticket;
+    pool.start([this, original, ticket, input]() {
+        QThread::currentThread()->setPriority(QThread::LowPriority);
+        if (Tracer::isEnabled())
+            Tracer::instance().setThreadName("LOD builder");
+        PROFILE_SCOPE("LODBuilder::build");
+
+        std::vector<vtkSmartPointer<vtkPolyData>> levels = BuildLevelsOfDetail(input);
+
+        QMetaObject::invokeMethod(this, [this, original, ticket, levels]() {
+            // Ignore results for geometry that was deleted or rebuilt since
+            auto it = entries.find(original);
+            if (it == entries.end() || it->ticket != ticket || !it->source) {
+                if (it != entries.end() && it->ticket == ticket)
+                    entries.erase(it);
+                return;
+            }
+
+            std::vector<vtkSmartPointer<vtkPolyDataMapper>> mappers;
+            for (const auto& level : levels) {
+                auto mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+                mapper->SetInputData(level);
+                mappers.push_back(mapper);
+            }
+
+            it->mappers.assign(mappers.begin(), mappers.end());
+            it->building = false;
+
+            const QList<ModelPart*> parts = it->waiting;
+            it->waiting.clear();
+            for (ModelPart* part : parts) {
+                part->setLODMappers(mappers);
+                detailed.insert(part);
+                emit lodReady(part);
+            }
+        }, Qt::QueuedConnection);
+    });
+}
+
+void LODBuilder::cancel(ModelPart* part) {
+    for (Entry& entry : entries)
+        entry.waiting.removeAll(part);
+    detailed.remove(part);
+
+    for (int i = 0; i < part->childCount(); ++i)
+        cancel(part->child(i));
+}
@@ -0,0 +1,129 @@
+#ifndef LEVEL_OF_DETAIL_H
+#define LEVEL_OF_DETAIL_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QThreadPool>
+
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+#include <vtkPolyDataMapper.h>
+#include <vtkPolyData.h>
+#include <vtkRenderer.h>
+
+class ModelPart;
+
+/**
+ * @file
+ * This file contains the level-of-detail support for model parts: building
+ * decimated copies of a mesh in the background and choosing which copy to draw.
+ */
+
+/**
+ * @brief Fractions of the original triangles kept by each decimated level.
+ */
+const std::vector<double> DefaultLODFractions = { 0.5, 0.1, 0.02 };
+
+/**
+ * @brief Parts with fewer triangles than this are not decimated.
+ */
+const vtkIdType MinLODTriangles = 20000;
+
+/**
+ * @brief Builds decimated copies of a mesh with quadric decimation.
+ *
+ * Each level is decimated from the previous one, so the coarse levels are cheap.
+ * Safe to call from any thread as long as nothing modifies the input meanwhile.
+ *
+ * @param input The full resolution mesh.
+ * @param fractions Fraction of the input's triangles to keep per level, finest first.
+ * @return One mesh per fraction, each with point normals.
+ */
+std::vector<vtkSmartPointer<vtkPolyData>> BuildLevelsOfDetail(vtkPolyData* input, const std::vector<double>& fractions = DefaultLODFractions);
+
+/**
+ * @brief Chooses the level of detail of the given parts for the next frame.
+ *
+ * A part's level depends on the height of its bounding sphere on screen, in pixels,
+ * divided by the bias. Raising the bias moves every part to coarser levels.
+ * Only parts with decimated levels need to be passed, see LODBuilder::detailedParts(),
+ * so the cost per frame does not grow with the small parts of an assembly.
+ *
+ * @param renderer The renderer about to draw the parts.
+ * @param parts The parts to choose levels for.
+ * @param bias Frame-time bias, 1 for no bias.
+ */
+void SelectLevelsOfDetail(vtkRenderer* renderer, const QSet<ModelPart*>& parts, double bias);
+
+ /**
+  * @class LODBuilder
+  * @brief Builds level-of-detail meshes for parts on a background thread pool.
+  *
+  * Results are handed to the parts on the thread that owns the builder. Levels are
+  * built once per geometry and their mappers are shared by every part showing it.
+  * The builder also tracks which parts have levels, so per-frame selection only
+  * visits those. Parts must be passed to cancel() before they are deleted.
+  */
+class LODBuilder : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the builder with a low priority worker pool.
+     * @param parent Parent QObject.
+     */
+    explicit LODBuilder(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor. Drops queued builds and waits for running ones.
+     */
+    ~LODBuilder() override;
+
+    /**
+     * @brief Gives a part the levels of its geometry, queueing decimation if they do not
+     * exist yet. Does nothing for small meshes.
+     * @param part The part, which must already have geometry.
+     */
+    void build(ModelPart* part);
+
+    /**
+     * @brief Discards pending results for a part and all its children and stops tracking them.
+     * @param part The part about to be deleted.
+     */
+    void cancel(ModelPart* part);
+
+    /**
+     * @brief Returns the parts that have been given decimated levels and not cancelled since.
+     */
+    const QSet<ModelPart*>& detailedParts() const { return detailed; }
+
+signals:
+    /**
+     * @brief Emitted once a part's levels have been set.
+     * @param part The part that was updated.
+     */
+    void lodReady(ModelPart* part);
+
+private:
+    /**
+     * @brief Levels built, or being built, for one geometry.
+     */
+    struct Entry {
+        vtkWeakPointer<vtkPolyData> source;  /**< The geometry, cleared once deleted */
+        quint64 ticket = 0;                  /**< Identifies the latest build */
+        bool building = false;               /**< Whether the build is still running */
+        QList<ModelPart*> waiting;           /**< Parts to receive the levels once built */
+        std::vector<vtkWeakPointer<vtkPolyDataMapper>> mappers; /**< Mappers held by the parts using them */
+    };
+
+    QThreadPool pool;                      /**< Worker threads used for decimation */
+    QHash<vtkPolyData*, Entry> entries;    /**< Levels per original geometry */
+    quint64 nextTicket = 0;                /**< Ticket for the next build */
+    QSet<ModelPart*> detailed;             /**< Parts that have been given levels */
+};
+
+#endif // LEVEL_OF_DETAIL_H
@@ -1,9 +1,20 @@
 #include "mainwindow.h"
+#include "headless.h"
 
 #include <QApplication>
+#include <QCoreApplication>
 
 int main(int argc, char *argv[])
 {
+    // Batch rendering for machines without a display: no QApplication, no widgets
+    if (IsHeadlessRequested(argc, argv)) {
+        QCoreApplication a(argc, argv);
+        HeadlessOptions options;
+        if (!ParseHeadlessArguments(a, options))
+            return 2;
+        return RunHeadless(options);
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
     w.show();
@@ -10,7 +10,11 @@
 #include "skyboxutils.h"
 #include "ModelPartList.h"
 #include "ModelPart.h"
-#include "VRRenderThread.h"
+#include "stlloader.h"
+#include "levelofdetail.h"
+#include "scenesync.h"
+#include "framescheduler.h"
+#include "vrrenderthread.h"
 #include <QVTKOpenGLNativeWidget.h>
 #include <vtkSmartPointer.h>
 #include <vtkRenderer.h>
@@ -18,6 +22,7 @@
 #include <vtkActor.h>  
 #include <vtkLight.h>  
 #include <QTimer>
+#include <QProgressBar>
 #include "backgrounddialog.h"
 #include <vtkImageReader2Factory.h>
 #include <vtkImageReader2.h>
@@ -30,6 +35,8 @@
 #include <vtkPlane.h>
 #include <vtkGeometryFilter.h>
 #include <vtkSkybox.h> 
+#include <vtkTextActor.h>
+#include <QElapsedTimer>
 
 /**
  * @file
@@ -95,7 +102,7 @@ public slots:
     void on_actionItemOptions_triggered();
 
     /**
-     * @brief Updates the 3D render window.
+     * @brief Applies pending scene changes and updates the 3D render window.
      */
     void updateRender();
 
@@ -104,11 +111,6 @@ public slots:
      */
     void toggleTreeView();
 
-    /**
-     * @brief Updates rendering based on the selected item in the tree view.
-     * @param index Index of the selected tree item.
-     */
-    void updateRenderFromTree(const QModelIndex& index);
 
     /**
      * @brief Updates lighting based on the slider value.
@@ -176,9 +178,10 @@ private slots:
     void onShrinkFilterCheckboxChanged(int state);
 
     /**
-     * @brief Updates the VR renderer to reflect current scene.
+     * @brief Pushes the colour, visibility and transform of a part to the running VR thread.
+     * @param part The model part to update.
      */
-    void updateVRRenderer();
+    void updateVRPart(ModelPart* part);
 
     /**
      * @brief Updates the VR background with a solid color.
@@ -193,16 +196,56 @@ private slots:
     void onRotationSpeedChanged(int value);
 
     /**
-     * @brief Applies rotation to models.
+     * @brief Advances the model rotation by the time since the last frame.
+     * @param dt Seconds since the last frame.
+     */
+    void rotateModels(double dt);
+
+    /**
+     * @brief Gives a placeholder part the geometry parsed by the background loader.
+     * @param fileName The STL file that was parsed.
+     * @param data The parsed geometry.
+     * @param part Placeholder tree item created for the file by openFile().
+     */
+    void onFileLoaded(const QString& fileName, vtkSmartPointer<vtkPolyData> data, const QPersistentModelIndex& part);
+
+    /**
+     * @brief Records a placeholder whose file could not be parsed, for removal once loading ends.
+     * @param fileName The STL file that failed.
+     * @param part Placeholder tree item created for the file.
+     */
+    void onFileFailed(const QString& fileName, const QPersistentModelIndex& part);
+
+    /**
+     * @brief Updates the status bar while files are loading.
+     * @param done Number of files finished.
+     * @param total Number of files queued.
+     */
+    void onLoadProgress(int done, int total);
+
+    /**
+     * @brief Refreshes the scene once a batch of files has loaded.
+     * @param loaded Number of files parsed successfully.
+     * @param failed Number of files that could not be parsed.
+     */
+    void onLoadFinished(int loaded, int failed);
+
+    /**
+     * @brief Turns frame-time profiling and the on-screen statistics overlay on or off.
      */
-    void rotateModels();
+    void toggleProfiling();
 
     /**
-     * @brief Recursively rotates a model part.
-     * @param part The model part to rotate.
-     * @param speed Rotation speed.
+     * @brief Starts or finishes writing a Chrome trace of every thread's timeline.
      */
-    void rotatePartRecursive(ModelPart* part, int speed);
+    void toggleTracing();
+
+    /**
+     * @brief Refreshes the frame rate and frame time shown in the overlay.
+     * @param dt Seconds since the last frame.
+     */
+    void updateStatsOverlay(double dt);
+
 
 private:
     Ui::MainWindow* ui;  /**< Pointer to the UI */
@@ -214,19 +257,56 @@ private:
     vtkSmartPointer<vtkActor> gridActor;  /**< Actor for background grid */
     vtkSmartPointer<vtkLight> light;  /**< Light source for the scene */
     vtkSmartPointer<vtkTexturedActor2D> backgroundActor;  /**< 2D background actor */
+    vtkSmartPointer<vtkActor> placeholderActor;  /**< Demo cylinder shown until the scene is first updated */
+
+    SceneSync* sceneSync = nullptr;  /**< Applies added, removed and changed parts to the renderer */
 
     VRRenderThread* vrThread = nullptr;  /**< VR rendering thread */
 
+    STLLoader* loader = nullptr;  /**< Background STL parser */
+    QProgressBar* loadProgress = nullptr;  /**< Status bar progress for file loading */
+    QList<QPersistentModelIndex> failedLoads;  /**< Placeholders of files that could not be parsed */
+
+    LODBuilder* lodBuilder = nullptr;  /**< Background level-of-detail decimation */
+    double lodFrameBudget = 1.0 / 30.0;  /**< Target frame time in seconds */
+    double lodBias = 1.0;  /**< Grows while frames take longer than the budget */
+
+    /**
+     * @brief Picks each part's level of detail before the renderer draws a frame.
+     *
+     * Adapts the bias to the time the previous frame took, then selects levels
+     * from on-screen size.
+     */
+    void updateLevelOfDetail();
+
     /**
      * @brief Sends the model part recursively to the VR renderer.
      * @param part The model part to send.
      */
     void sendPartRecursive(ModelPart* part);
 
-    QTimer* rotationTimer = nullptr;  /**< Timer for rotation updates */
-    int rotationSpeed = 0;  /**< Current model rotation speed */
+    /**
+     * @brief Removes the model part and its children from the VR scene.
+     * @param part The model part to remove.
+     */
+    void removePartFromVRRecursive(ModelPart* part);
+
+    /**
+     * @brief Sends the current geometry of the part and its children to the VR renderer.
+     * @param part The model part whose geometry changed.
+     */
+    void sendGeometryRecursive(ModelPart* part);
+
+    FrameScheduler* frames = nullptr;  /**< Renders on demand, continuously only while rotating */
+    int rotationSpeed = 0;  /**< Current model rotation speed, in degrees per 50 ms */
 
     vtkSmartPointer<vtkSkybox> skybox;  /**< Skybox for the 3D scene */
+
+    vtkSmartPointer<vtkTextActor> statsOverlay;  /**< Frame rate and frame time text, shown while profiling */
+    QElapsedTimer statsClock;  /**< Time since the overlay was last refreshed */
+    QTimer statsTimer;  /**< Redraws the overlay while VR runs, as the desktop view may be idle */
+    quint64 statsFrames = 0;  /**< Frames rendered when the overlay was last refreshed */
+    QString profileDumpFile;  /**< Where percentiles are written on exit, from VRCAD_PROFILE */
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,95 @@
+#include "openvrbackend.h"
+
+#include <openvr.h>
+
+#include <vtkNew.h>
+#include <vtkMatrix4x4.h>
+#include <vtkEventData.h>
+
+vtkRenderer* OpenVRBackend::renderer() {
+    if (!vrRenderer)
+        vrRenderer = vtkSmartPointer<vtkOpenVRRenderer>::New();
+    return vrRenderer;
+}
+
+/**
+ * @brief Opens the headset and takes the refresh rate from it, so dropped frames are
+ * counted against the real display.
+ */
+bool OpenVRBackend::start() {
+    window = vtkSmartPointer<vtkOpenVRRenderWindow>::New();
+    window->Initialize();
+    if (!window->GetHMD())
+        return false;
+    window->AddRenderer(renderer());
+
+    camera = vtkSmartPointer<vtkOpenVRCamera>::New();
+    vrRenderer->SetActiveCamera(camera);
+
+    interactor = vtkSmartPointer<vtkOpenVRRenderWindowInteractor>::New();
+    interactor->SetRenderWindow(window);
+    interactor->Initialize();
+
+    setRefreshRate(window->GetHMD()->GetFloatTrackedDeviceProperty(
+        vr::k_unTrackedDeviceIndex_Hmd, vr::Prop_DisplayFrequency_Float));
+
+    window->Render();
+    framePresented();
+    return true;
+}
+
+bool OpenVRBackend::renderFrame() {
+    interactor->DoOneEvent(window, vrRenderer);
+    framePresented();
+    return !interactor->GetDone();
+}
+
+void OpenVRBackend::stop() {
+    if (interactor)
+        interactor->TerminateApp();
+    if (window)
+        window->Finalize();
+}
+
+/**
+ * @brief The OpenVR camera follows the headset, so its pose is the head pose.
+ */
+HeadPose OpenVRBackend::headPose() const {
+    HeadPose pose;
+    if (camera) {
+        camera->GetPosition(pose.position);
+        camera->GetFocalPoint(pose.focalPoint);
+        camera->GetViewUp(pose.viewUp);
+    }
+    return pose;
+}
+
+/**
+ * @brief Controllers point along their -Z axis, like the VTK ray.
+ */
+bool OpenVRBackend::controllerPose(int hand, HeadPose& pose) const {
+    if (!window)
+        return false;
+
+    vtkNew<vtkMatrix4x4> deviceToWorld;
+    const vtkEventDataDevice device = hand == 0 ? vtkEventDataDevice::LeftController : vtkEventDataDevice::RightController;
+    if (!window->GetDeviceToWorldMatrixForDevice(device, deviceToWorld))
+        return false;
+
+    for (int i = 0; i < 3; ++i) {
+        pose.position[i] = deviceToWorld->GetElement(i, 3);
+        pose.focalPoint[i] = pose.position[i] - deviceToWorld->GetElement(i, 2);
+        pose.viewUp[i] = deviceToWorld->GetElement(i, 1);
+    }
+    return true;
+}
+
+qint64 OpenVRBackend::nanosecondsToVsync() const {
+    float sinceVsync = 0;
+    uint64_t frameCounter = 0;
+    if (!window || !window->GetHMD() || !window->GetHMD()->GetTimeSinceLastVsync(&sinceVsync, &frameCounter))
+        return -1;
+
+    const qint64 remaining = static_cast<qint64>((frameStats.targetFrameMs / 1000.0 - sinceVsync) * 1e9);
+    return remaining > 0 ? remaining : 0;
+}
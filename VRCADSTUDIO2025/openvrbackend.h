@@ -0,0 +1,42 @@
+#ifndef OPENVR_BACKEND_H
+#define OPENVR_BACKEND_H
+
+#include "vrbackend.h"
+
+#include <vtkSmartPointer.h>
+#include <vtkOpenVRRenderWindow.h>
+#include <vtkOpenVRRenderWindowInteractor.h>
+#include <vtkOpenVRRenderer.h>
+#include <vtkOpenVRCamera.h>
+
+/**
+ * @file
+ * This file contains the VR backend that renders to a SteamVR headset.
+ */
+
+/**
+ * @class OpenVRBackend
+ * @brief Renders to the headset through VTK's OpenVR module.
+ *
+ * Each frame runs one DoOneEvent() of the OpenVR interactor, which handles the
+ * controllers and renders and submits both eyes.
+ */
+class OpenVRBackend : public VRBackend {
+public:
+    QString name() const override { return "OpenVR"; }
+    vtkRenderer* renderer() override;
+    bool start() override;
+    bool renderFrame() override;
+    void stop() override;
+    HeadPose headPose() const override;
+    bool controllerPose(int hand, HeadPose& pose) const override;
+    qint64 nanosecondsToVsync() const override;
+
+private:
+    vtkSmartPointer<vtkOpenVRRenderWindow> window; /**< VR render window */
+    vtkSmartPointer<vtkOpenVRRenderWindowInteractor> interactor; /**< VR interactor */
+    vtkSmartPointer<vtkOpenVRRenderer> vrRenderer; /**< VR renderer */
+    vtkSmartPointer<vtkOpenVRCamera> camera; /**< VR camera */
+};
+
+#endif // OPENVR_BACKEND_H
@@ -0,0 +1,164 @@
+#include "profiler.h"
+
+#include <QFile>
+#include <QTextStream>
+#include <QHash>
+
+#include <algorithm>
+#include <chrono>
+
+std::atomic<bool> Profiler::enabled{ false };
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::setEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+qint64 Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::BufferHandle::~BufferHandle() {
+    if (!buffer)
+        return;
+
+    Profiler& profiler = Profiler::instance();
+    QMutexLocker locker(&profiler.mutex);
+    profiler.freeBuffers.push_back(buffer);
+}
+
+/**
+ * @brief Each thread looks its buffer up once; the lock is only taken to take one
+ * from the free list or register a new one.
+ */
+Profiler::ThreadBuffer* Profiler::localBuffer() {
+    thread_local BufferHandle handle;
+    if (!handle.buffer) {
+        QMutexLocker locker(&mutex);
+        if (!freeBuffers.empty()) {
+            handle.buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+        }
+        else {
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            handle.buffer = buffers.back().get();
+        }
+    }
+    return handle.buffer;
+}
+
+/**
+ * @brief Overwrites the oldest slot of the calling thread's buffer.
+ */
+void Profiler::record(const char* name, qint64 startNs, qint64 durationNs) {
+    ThreadBuffer* buffer = localBuffer();
+    const quint64 index = buffer->written.load(std::memory_order_relaxed);
+    Sample& sample = buffer->samples[index % Capacity];
+
+    const quint32 sequence = sample.sequence.load(std::memory_order_relaxed);
+    sample.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    sample.name.store(name, std::memory_order_relaxed);
+    sample.start.store(startNs, std::memory_order_relaxed);
+    sample.duration.store(durationNs, std::memory_order_relaxed);
+
+    sample.sequence.store(sequence + 2, std::memory_order_release);
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Gathers durations per name from every buffer and takes nearest-rank percentiles.
+ */
+QMap<QString, Profiler::Stats> Profiler::statistics() const {
+    QHash<const char*, std::vector<qint64>> durations;
+
+    {
+        QMutexLocker locker(&mutex);
+        for (const auto& buffer : buffers) {
+            const quint64 written = buffer->written.load(std::memory_order_acquire);
+            const quint64 oldest = written > Capacity ? written - Capacity : 0;
+            const quint64 first = std::max(oldest, buffer->cleared.load(std::memory_order_relaxed));
+
+            for (quint64 i = first; i < written; ++i) {
+                const Sample& sample = buffer->samples[i % Capacity];
+
+                const quint32 before = sample.sequence.load(std::memory_order_acquire);
+                const char* name = sample.name.load(std::memory_order_relaxed);
+                const qint64 duration = sample.duration.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                const quint32 after = sample.sequence.load(std::memory_order_relaxed);
+
+                // Skip slots the owning thread was writing while we read them
+                if ((before & 1) || before != after || !name)
+                    continue;
+                durations[name].push_back(duration);
+            }
+        }
+    }
+
+    // The same name may come from different string literals, so merge by text
+    QMap<QString, std::vector<qint64>> byName;
+    for (auto it = durations.begin(); it != durations.end(); ++it) {
+        std::vector<qint64>& values = byName[QString::fromLatin1(it.key())];
+        values.insert(values.end(), it.value().begin(), it.value().end());
+    }
+
+    QMap<QString, Stats> result;
+    for (auto it = byName.begin(); it != byName.end(); ++it) {
+        std::vector<qint64>& values = it.value();
+        std::sort(values.begin(), values.end());
+
+        auto percentile = [&values](double p) {
+            const size_t rank = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+            return values[rank] / 1e6;
+        };
+
+        Stats stats;
+        stats.count = static_cast<int>(values.size());
+        double total = 0;
+        for (qint64 value : values)
+            total += value;
+        stats.meanMs = total / values.size() / 1e6;
+        stats.p50Ms = percentile(0.50);
+        stats.p95Ms = percentile(0.95);
+        stats.p99Ms = percentile(0.99);
+        stats.maxMs = values.back() / 1e6;
+        result.insert(it.key(), stats);
+    }
+    return result;
+}
+
+bool Profiler::dumpPercentiles(const QString& fileName) const {
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+
+    QTextStream out(&file);
+    out << "scope,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+
+    const QMap<QString, Stats> stats = statistics();
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        const Stats& s = it.value();
+        out << it.key() << ',' << s.count << ',' << s.meanMs << ',' << s.p50Ms << ','
+            << s.p95Ms << ',' << s.p99Ms << ',' << s.maxMs << '\n';
+    }
+    return out.status() == QTextStream::Ok;
+}
+
+/**
+ * @brief Moves each buffer's start past the samples written so far.
+ *
+ * Only the owning thread writes to the slots and the sample count, so rather than
+ * wiping slots under a writer, readers are told where the kept samples begin.
+ */
+void Profiler::clear() {
+    QMutexLocker locker(&mutex);
+    for (const auto& buffer : buffers)
+        buffer->cleared.store(buffer->written.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
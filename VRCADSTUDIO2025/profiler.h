@@ -0,0 +1,180 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <QString>
+#include <QMap>
+#include <QMutex>
+#include <QtGlobal>
+
+#include "tracer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+/**
+ * @file
+ * This file contains the frame-time instrumentation: scoped timers that record into
+ * per-thread ring buffers, and the statistics read back from them.
+ */
+
+ /**
+  * @class Profiler
+  * @brief Collects the durations of named scopes from every thread.
+  *
+  * Each thread writes into its own fixed-size ring buffer, so recording never takes a
+  * lock. Only the most recent samples per thread are kept. When profiling is disabled
+  * a PROFILE_SCOPE costs two relaxed atomic loads, one for the Tracer.
+  *
+  * A thread's buffer goes back to a free list when the thread exits and is handed to
+  * the next new thread, so pool threads that retire and respawn do not add buffers.
+  * Its samples stay in the statistics until they are overwritten.
+  */
+class Profiler {
+public:
+    /**
+     * @brief Summary of the samples recorded for one scope name.
+     */
+    struct Stats {
+        int count = 0;       /**< Number of samples */
+        double meanMs = 0;   /**< Mean duration */
+        double p50Ms = 0;    /**< Median duration */
+        double p95Ms = 0;    /**< 95th percentile duration */
+        double p99Ms = 0;    /**< 99th percentile duration */
+        double maxMs = 0;    /**< Longest duration */
+    };
+
+    /**
+     * @brief Returns the profiler shared by the whole application.
+     */
+    static Profiler& instance();
+
+    /**
+     * @brief Returns whether scopes are being recorded.
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Starts or stops recording.
+     */
+    void setEnabled(bool enable);
+
+    /**
+     * @brief Returns a steady timestamp in nanoseconds.
+     */
+    static qint64 now();
+
+    /**
+     * @brief Records one sample into the calling thread's buffer.
+     * @param name Scope name. Must be a string literal or otherwise outlive the profiler.
+     * @param startNs Start time from now().
+     * @param durationNs Duration in nanoseconds.
+     */
+    void record(const char* name, qint64 startNs, qint64 durationNs);
+
+    /**
+     * @brief Computes statistics per scope name over the samples currently buffered.
+     */
+    QMap<QString, Stats> statistics() const;
+
+    /**
+     * @brief Writes the statistics as a table of percentiles in milliseconds.
+     * @param fileName File to write.
+     * @return false if the file could not be written.
+     */
+    bool dumpPercentiles(const QString& fileName) const;
+
+    /**
+     * @brief Discards all buffered samples.
+     *
+     * Threads may keep recording meanwhile; samples written before the call are no
+     * longer reported.
+     */
+    void clear();
+
+private:
+    Profiler() = default;
+
+    static const int Capacity = 4096;  /**< Samples kept per thread */
+
+    /**
+     * @brief One ring buffer slot, guarded by a sequence number so readers can skip
+     * slots that are being overwritten.
+     */
+    struct Sample {
+        std::atomic<quint32> sequence{ 0 };      /**< Odd while the slot is being written */
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<qint64> start{ 0 };
+        std::atomic<qint64> duration{ 0 };
+    };
+
+    /**
+     * @brief Ring buffer owned by one thread.
+     */
+    struct ThreadBuffer {
+        Sample samples[Capacity];                /**< Most recent samples */
+        std::atomic<quint64> written{ 0 };       /**< Total samples written */
+        std::atomic<quint64> cleared{ 0 };       /**< Samples before this were discarded by clear() */
+    };
+
+    /**
+     * @brief Hands a thread's buffer back to the free list when the thread exits.
+     */
+    struct BufferHandle {
+        ThreadBuffer* buffer = nullptr;
+        ~BufferHandle();
+    };
+
+    /**
+     * @brief Returns the calling thread's buffer, taking one on first use.
+     */
+    ThreadBuffer* localBuffer();
+
+    static std::atomic<bool> enabled;            /**< Whether scopes record */
+    mutable QMutex mutex;                        /**< Guards buffers and freeBuffers */
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; /**< Every buffer, in use or free */
+    std::vector<ThreadBuffer*> freeBuffers;      /**< Buffers of exited threads, reused first */
+};
+
+ /**
+  * @class ProfileScope
+  * @brief Records the time between its construction and destruction under a name.
+  *
+  * The duration goes to the Profiler and, while a trace is running, the scope is also
+  * written to the timeline as a begin/end pair.
+  */
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(name), profiled(Profiler::isEnabled()), traced(Tracer::isEnabled()),
+          start(profiled ? Profiler::now() : 0) {
+        if (traced)
+            Tracer::instance().begin(name);
+    }
+
+    ~ProfileScope() {
+        if (traced)
+            Tracer::instance().end(name);
+        if (profiled)
+            Profiler::instance().record(name, start, Profiler::now() - start);
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;  /**< Scope name */
+    bool profiled;     /**< Profiling was enabled on entry */
+    bool traced;       /**< Tracing was enabled on entry */
+    qint64 start;      /**< Time the scope was entered */
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Times the rest of the enclosing block under the given name.
+ */
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+
+#endif // PROFILER_H
@@ -0,0 +1,163 @@
+#include "scenesync.h"
+#include "ModelPart.h"
+
+#include <vtkPropCollection.h>
+#include <vtkProp.h>
+#include <vtkProperty.h>
+#include <vtkTexture.h>
+#include <vtkMapper.h>
+#include <vtkRenderWindow.h>
+
+#include <vector>
+
+namespace {
+    // Above this many removals one pass over the renderer's props beats one search each
+    const int BatchRemoveThreshold = 32;
+}
+
+SceneSync::SceneSync(vtkRenderer* renderer)
+    : renderer(renderer)
+{
+}
+
+void SceneSync::markAdded(ModelPart* part) {
+    dirty.insert(part);
+
+    for (int i = 0; i < part->childCount(); ++i)
+        markAdded(part->child(i));
+}
+
+void SceneSync::markChanged(ModelPart* part) {
+    dirty.insert(part);
+}
+
+/**
+ * @brief Forgets the subtree straight away, keeping its actors to remove on apply().
+ */
+void SceneSync::markRemoved(ModelPart* part) {
+    dirty.remove(part);
+
+    auto it = shown.find(part);
+    if (it != shown.end()) {
+        removed.append(it.value());
+        shown.erase(it);
+    }
+
+    for (int i = 0; i < part->childCount(); ++i)
+        markRemoved(part->child(i));
+}
+
+/**
+ * @brief Applies the removals, then adds or swaps the actors of the dirty parts.
+ *
+ * vtkRenderer::AddActor searches all props to avoid duplicates. The shown table
+ * already says whether an actor is present, so new actors are appended to the
+ * prop collection directly and each add is constant time.
+ */
+int SceneSync::apply() {
+    QSet<vtkActor*> toRemove;
+    for (const auto& actor : removed)
+        toRemove.insert(actor);
+
+    std::vector<std::pair<ModelPart*, vtkActor*>> toAdd;
+    for (ModelPart* part : dirty) {
+        vtkActor* actor = part->getActor();
+        vtkActor* current = shown.value(part);
+        if (actor == current)
+            continue;
+
+        if (current) {
+            toRemove.insert(current);
+            shown.remove(part);
+        }
+        if (actor)
+            toAdd.emplace_back(part, actor);
+    }
+
+    for (const auto& entry : toAdd) {
+        renderer->GetViewProps()->AddItem(entry.second);
+        entry.second->AddConsumer(renderer);
+        shown.insert(entry.first, entry.second);
+    }
+    if (!toAdd.empty())
+        renderer->Modified();
+
+    // After the adds, so a mapper moving to a part's new actor counts as still in use
+    removeActors(toRemove);
+
+    const int changes = toRemove.size() + static_cast<int>(toAdd.size());
+    dirty.clear();
+    removed.clear();
+    return changes;
+}
+
+/**
+ * @brief Releases what an actor holds on the GPU, as vtkRenderer::RemoveViewProp does.
+ *
+ * Parts loaded from the same file share one mapper. While another shown actor still
+ * draws with it, only the actor's own property and texture are released, so the
+ * remaining instances do not have to upload the geometry again.
+ */
+void SceneSync::releaseActors(const QSet<vtkActor*>& actors) {
+    vtkRenderWindow* window = renderer->GetRenderWindow();
+    if (!window)
+        return;
+
+    QSet<vtkMapper*> inUse;
+    for (const auto& actor : shown)
+        inUse.insert(actor->GetMapper());
+
+    for (vtkActor* actor : actors) {
+        if (!inUse.contains(actor->GetMapper())) {
+            actor->ReleaseGraphicsResources(window);
+            continue;
+        }
+        if (actor->GetTexture())
+            actor->GetTexture()->ReleaseGraphicsResources(window);
+        actor->GetProperty()->ReleaseGraphicsResources(window);
+        if (actor->GetBackfaceProperty())
+            actor->GetBackfaceProperty()->ReleaseGraphicsResources(window);
+    }
+}
+
+/**
+ * @brief Takes actors out of the renderer. Few are searched for one by one, many in a single pass.
+ */
+void SceneSync::removeActors(const QSet<vtkActor*>& actors) {
+    if (actors.isEmpty())
+        return;
+
+    releaseActors(actors);
+
+    vtkPropCollection* props = renderer->GetViewProps();
+    if (actors.size() < BatchRemoveThreshold) {
+        for (vtkActor* actor : actors) {
+            actor->RemoveConsumer(renderer);
+            props->RemoveItem(actor);
+        }
+        renderer->Modified();
+        return;
+    }
+
+    // Rebuild the prop collection without the removed actors
+    std::vector<vtkSmartPointer<vtkProp>> kept;
+    kept.reserve(props->GetNumberOfItems());
+
+    vtkCollectionSimpleIterator it;
+    props->InitTraversal(it);
+    while (vtkProp* prop = props->GetNextProp(it)) {
+        if (actors.contains(vtkActor::SafeDownCast(prop)))
+            prop->RemoveConsumer(renderer);
+        else
+            kept.emplace_back(prop);
+    }
+
+    props->RemoveAllItems();
+    for (const auto& prop : kept)
+        props->AddItem(prop);
+    renderer->Modified();
+}
+
+int SceneSync::size() const {
+    return shown.size();
+}
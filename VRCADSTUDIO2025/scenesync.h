@@ -0,0 +1,82 @@
+#ifndef SCENE_SYNC_H
+#define SCENE_SYNC_H
+
+#include <QHash>
+#include <QSet>
+#include <QList>
+
+#include <vtkSmartPointer.h>
+#include <vtkRenderer.h>
+#include <vtkActor.h>
+
+class ModelPart;
+
+/**
+ * @file
+ * This file contains the declaration of the SceneSync class, which keeps a renderer's
+ * actors in step with the model tree.
+ */
+
+ /**
+  * @class SceneSync
+  * @brief Applies only what changed in the model tree to a renderer.
+  *
+  * Every part with an actor has that actor in the renderer. Parts that are hidden
+  * stay there with their actor's visibility switched off, so showing or hiding a part
+  * never touches the renderer. Parts that are added, removed or given a new actor are
+  * marked dirty and applied in one go by apply().
+  *
+  * Props that are not parts, such as the grid, skybox and background, are left alone.
+  */
+class SceneSync {
+public:
+    /**
+     * @brief Constructs the sync layer for a renderer.
+     * @param renderer The renderer the part actors are added to.
+     */
+    explicit SceneSync(vtkRenderer* renderer);
+
+    /**
+     * @brief Marks a part and all its children as added.
+     */
+    void markAdded(ModelPart* part);
+
+    /**
+     * @brief Marks a part whose actor may have been created or replaced.
+     */
+    void markChanged(ModelPart* part);
+
+    /**
+     * @brief Marks a part and all its children as removed. Must be called before they are deleted.
+     */
+    void markRemoved(ModelPart* part);
+
+    /**
+     * @brief Adds and removes actors for everything marked since the last call.
+     * @return The number of actors added or removed.
+     */
+    int apply();
+
+    /**
+     * @brief Returns the number of part actors in the renderer.
+     */
+    int size() const;
+
+private:
+    /**
+     * @brief Takes a set of actors out of the renderer and releases their graphics resources.
+     */
+    void removeActors(const QSet<vtkActor*>& actors);
+
+    /**
+     * @brief Releases the graphics resources of removed actors, keeping mappers still in use.
+     */
+    void releaseActors(const QSet<vtkActor*>& actors);
+
+    vtkSmartPointer<vtkRenderer> renderer;                /**< Renderer being kept in sync */
+    QHash<ModelPart*, vtkSmartPointer<vtkActor>> shown;   /**< Actor in the renderer per part */
+    QSet<ModelPart*> dirty;                               /**< Parts to check on the next apply */
+    QList<vtkSmartPointer<vtkActor>> removed;             /**< Actors of deleted parts to remove */
+};
+
+#endif // SCENE_SYNC_H
@@ -0,0 +1,198 @@
+#include "simulatedhmd.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include <vtkCamera.h>
+#include <vtkMath.h>
+
+namespace {
+    const double Pi = 3.14159265358979323846;
+
+    /**
+     * @brief A head 2.5 radii in front of the scene and slightly above its centre.
+     */
+    HeadPose frontOf(const double center[3], double radius) {
+        HeadPose pose;
+        for (int i = 0; i < 3; ++i)
+            pose.focalPoint[i] = center[i];
+        pose.position[0] = center[0];
+        pose.position[1] = center[1] + 0.3 * radius;
+        pose.position[2] = center[2] + 2.5 * radius;
+        return pose;
+    }
+}
+
+SimulatedHMDBackend::PoseScript SimulatedHMDBackend::script(const QString& name) {
+    if (name == "static") {
+        return [](double, const double center[3], double radius) {
+            return frontOf(center, radius);
+        };
+    }
+
+    if (name == "sweep") {
+        return [](double seconds, const double center[3], double radius) {
+            HeadPose pose = frontOf(center, radius);
+            const double yaw = 0.6 * std::sin(2.0 * Pi * seconds / 8.0);
+            const double dx = pose.focalPoint[0] - pose.position[0];
+            const double dz = pose.focalPoint[2] - pose.position[2];
+            pose.focalPoint[0] = pose.position[0] + dx * std::cos(yaw) + dz * std::sin(yaw);
+            pose.focalPoint[2] = pose.position[2] - dx * std::sin(yaw) + dz * std::cos(yaw);
+            return pose;
+        };
+    }
+
+    return [](double seconds, const double center[3], double radius) {
+        HeadPose pose = frontOf(center, radius);
+        const double angle = 2.0 * Pi * seconds / 20.0;
+        const double distance = 2.5 * radius;
+        pose.position[0] = center[0] + distance * std::sin(angle);
+        pose.position[1] = center[1] + radius * (0.3 + 0.05 * std::sin(2.0 * Pi * seconds / 3.0));
+        pose.position[2] = center[2] + distance * std::cos(angle);
+        return pose;
+    };
+}
+
+SimulatedHMDBackend::SimulatedHMDBackend()
+    : poseScript(script("orbit"))
+{
+}
+
+void SimulatedHMDBackend::setEyeResolution(int width, int height) {
+    eyeWidth = width;
+    eyeHeight = height;
+}
+
+void SimulatedHMDBackend::setDisplayRate(double hz) {
+    displayRate = hz;
+}
+
+void SimulatedHMDBackend::setPoseScript(const PoseScript& script) {
+    poseScript = script;
+}
+
+void SimulatedHMDBackend::setDuration(double seconds) {
+    duration = seconds;
+}
+
+void SimulatedHMDBackend::setFramePoses(const std::vector<HeadPose>& poses) {
+    framePoses = poses;
+}
+
+vtkRenderer* SimulatedHMDBackend::renderer() {
+    if (!sceneRenderer)
+        sceneRenderer = vtkSmartPointer<vtkRenderer>::New();
+    return sceneRenderer;
+}
+
+/**
+ * @brief Measures the scene for the pose script and renders the first frame.
+ */
+bool SimulatedHMDBackend::start() {
+    setRefreshRate(displayRate);
+
+    window = vtkSmartPointer<vtkRenderWindow>::New();
+    window->SetOffScreenRendering(1);
+    window->SetSize(eyeWidth, eyeHeight);
+    window->AddRenderer(renderer());
+
+    double bounds[6];
+    sceneRenderer->ComputeVisiblePropBounds(bounds);
+    if (bounds[0] <= bounds[1]) {
+        for (int i = 0; i < 3; ++i)
+            sceneCenter[i] = 0.5 * (bounds[2 * i] + bounds[2 * i + 1]);
+        const double size[3] = { bounds[1] - bounds[0], bounds[3] - bounds[2], bounds[5] - bounds[4] };
+        sceneRadius = 0.5 * vtkMath::Norm(size);
+        if (sceneRadius <= 0)
+            sceneRadius = 1.0;
+    }
+
+    // Headsets have a field of view of around 100 degrees
+    sceneRenderer->GetActiveCamera()->SetViewAngle(100.0);
+
+    window->Render();
+    if (!window->SupportsOpenGL())
+        return false;
+
+    clock.start();
+    nextVsyncNs = 0;
+    frameIndex = 0;
+    framePresented();
+    return true;
+}
+
+/**
+ * @brief Renders the left then the right eye, waits for the GPU as a compositor
+ * would, then sleeps until the next refresh. A frame that misses its refresh waits
+ * for the one after, which is what a headset shows as a dropped frame.
+ */
+bool SimulatedHMDBackend::renderFrame() {
+    const double seconds = clock.nsecsElapsed() / 1e9;
+    if (framePoses.empty()) {
+        if (duration > 0 && seconds >= duration)
+            return false;
+        pose = poseScript(seconds, sceneCenter, sceneRadius);
+    }
+    else {
+        if (frameIndex >= framePoses.size())
+            return false;
+        pose = framePoses[frameIndex];
+    }
+    frameIndex++;
+
+    for (int eye : { -1, 1 }) {
+        placeEye(eye);
+        window->Render();
+    }
+    window->WaitForCompletion();
+
+    const qint64 period = static_cast<qint64>(1e9 / displayRate);
+    const qint64 now = clock.nsecsElapsed();
+    if (nextVsyncNs == 0)
+        nextVsyncNs = now + period;
+    while (nextVsyncNs <= now)
+        nextVsyncNs += period;
+    std::this_thread::sleep_for(std::chrono::nanoseconds(nextVsyncNs - now));
+    nextVsyncNs += period;
+
+    framePresented();
+    return true;
+}
+
+qint64 SimulatedHMDBackend::nanosecondsToVsync() const {
+    if (!clock.isValid())
+        return -1;
+    const qint64 remaining = nextVsyncNs - clock.nsecsElapsed();
+    return remaining > 0 ? remaining : 0;
+}
+
+void SimulatedHMDBackend::stop() {
+    window = nullptr;
+}
+
+/**
+ * @brief Offsets the camera sideways by half the eye separation, keeping the view
+ * axes parallel. The separation is scaled to the viewing distance, as 64 mm is to 2 m.
+ */
+void SimulatedHMDBackend::placeEye(int eye) {
+    double forward[3], up[3] = { pose.viewUp[0], pose.viewUp[1], pose.viewUp[2] }, right[3];
+    for (int i = 0; i < 3; ++i)
+        forward[i] = pose.focalPoint[i] - pose.position[i];
+    const double distance = vtkMath::Normalize(forward);
+    vtkMath::Cross(forward, up, right);
+    vtkMath::Normalize(right);
+
+    const double offset = eye * 0.5 * distance * (0.064 / 2.0);
+    double position[3], focalPoint[3];
+    for (int i = 0; i < 3; ++i) {
+        position[i] = pose.position[i] + offset * right[i];
+        focalPoint[i] = pose.focalPoint[i] + offset * right[i];
+    }
+
+    vtkCamera* camera = sceneRenderer->GetActiveCamera();
+    camera->SetPosition(position);
+    camera->SetFocalPoint(focalPoint);
+    camera->SetViewUp(pose.viewUp);
+    sceneRenderer->ResetCameraClippingRange();
+}
@@ -0,0 +1,109 @@
+#ifndef SIMULATED_HMD_H
+#define SIMULATED_HMD_H
+
+#include "vrbackend.h"
+
+#include <QElapsedTimer>
+
+#include <functional>
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkRenderWindow.h>
+
+/**
+ * @file
+ * This file contains a VR backend that needs no headset: it renders both eyes
+ * offscreen at headset resolution, paced like a headset compositor.
+ */
+
+/**
+ * @class SimulatedHMDBackend
+ * @brief Renders each eye offscreen and waits for a simulated vsync, like a headset.
+ *
+ * Head poses come from a script evaluated at the time since start(). The built-in
+ * scripts are placed relative to the bounds of the scene when the session starts,
+ * so they work whatever the size of the model.
+ */
+class SimulatedHMDBackend : public VRBackend {
+public:
+    /**
+     * @brief Head pose as a function of time.
+     *
+     * Receives the seconds since start() and the bounding sphere of the scene
+     * (centre and radius).
+     */
+    using PoseScript = std::function<HeadPose(double seconds, const double center[3], double radius)>;
+
+    /**
+     * @brief Returns a built-in pose script by name.
+     * @param name "orbit" circles the scene once every 20 s, "sweep" looks left and
+     * right from the front, "static" stays still. Anything else gives "orbit".
+     */
+    static PoseScript script(const QString& name);
+
+    SimulatedHMDBackend();
+
+    /**
+     * @brief Sets the per-eye resolution. Defaults to 1440 x 1600.
+     */
+    void setEyeResolution(int width, int height);
+
+    /**
+     * @brief Sets the refresh rate frames are paced to. Defaults to 90 Hz.
+     */
+    void setDisplayRate(double hz);
+
+    /**
+     * @brief Sets the script the head follows.
+     */
+    void setPoseScript(const PoseScript& script);
+
+    /**
+     * @brief Ends the session after the given time; zero runs until stopped.
+     */
+    void setDuration(double seconds);
+
+    /**
+     * @brief Replays recorded head poses, one per frame, instead of the script.
+     *
+     * The session ends after the last pose, so it lasts as many frames as the
+     * recording whatever the frame rate.
+     */
+    void setFramePoses(const std::vector<HeadPose>& poses);
+
+    HeadPose headPose() const override { return pose; }
+    qint64 nanosecondsToVsync() const override;
+
+    QString name() const override { return "Simulated HMD"; }
+    vtkRenderer* renderer() override;
+    bool start() override;
+    bool renderFrame() override;
+    void stop() override;
+
+private:
+    /**
+     * @brief Points the camera from one eye along the current head pose.
+     * @param eye -1 for the left eye, +1 for the right.
+     */
+    void placeEye(int eye);
+
+    int eyeWidth = 1440;            /**< Per-eye width in pixels */
+    int eyeHeight = 1600;           /**< Per-eye height in pixels */
+    double displayRate = 90.0;      /**< Simulated refresh rate */
+    double duration = 0.0;          /**< Session length, zero for unlimited */
+    PoseScript poseScript;          /**< Head motion */
+    std::vector<HeadPose> framePoses;  /**< Recorded head motion, used instead of the script if set */
+    size_t frameIndex = 0;          /**< Frames rendered since start() */
+    HeadPose pose;                  /**< Pose of the current frame */
+
+    double sceneCenter[3] = { 0, 0, 0 };  /**< Bounding sphere of the scene at start() */
+    double sceneRadius = 1.0;
+
+    vtkSmartPointer<vtkRenderer> sceneRenderer;  /**< Renderer holding the scene */
+    vtkSmartPointer<vtkRenderWindow> window;     /**< Offscreen window the eyes render into */
+    QElapsedTimer clock;                         /**< Time since start() */
+    qint64 nextVsyncNs = 0;                      /**< Next simulated display refresh */
+};
+
+#endif // SIMULATED_HMD_H
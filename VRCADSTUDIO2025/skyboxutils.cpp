@@ -5,6 +5,7 @@
 #include <vtkImageFlip.h>
 #include <vtkOpenGLTexture.h>
 #include <vtkRenderer.h>
+#include "profiler.h"
 #include <iostream>
 
 /**
@@ -18,6 +19,7 @@
  * @return A smart pointer to the resulting vtkOpenGLTexture.
  */
 vtkSmartPointer<vtkOpenGLTexture> LoadCubemapTexture(const std::vector<std::string>& faceFilenames) {
+    PROFILE_SCOPE("LoadCubemapTexture");
     auto texture = vtkSmartPointer<vtkOpenGLTexture>::New();
     texture->CubeMapOn();
     texture->SetUseSRGBColorSpace(true);
@@ -0,0 +1,317 @@
+#include "stlgenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const double Pi = 3.14159265358979323846;
+
+    /**
+     * @brief splitmix64. Unlike the standard distributions it gives the same sequence
+     * with every compiler and standard library.
+     */
+    class Random {
+    public:
+        explicit Random(std::uint64_t seed) : state(seed) {}
+
+        std::uint64_t next() {
+            std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        /** Uniform in [0, 1). */
+        double uniform() {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        double uniform(double low, double high) {
+            return low + (high - low) * uniform();
+        }
+
+    private:
+        std::uint64_t state;
+    };
+
+    /**
+     * @brief Torus radii and surface ripples drawn from a seed.
+     */
+    struct Shape {
+        static const int Harmonics = 3;
+        double majorRadius, minorRadius;
+        double amplitude[Harmonics], aroundMajor[Harmonics], aroundMinor[Harmonics], phase[Harmonics];
+
+        explicit Shape(std::uint64_t seed) {
+            Random random(seed);
+            majorRadius = random.uniform(1.0, 2.0);
+            minorRadius = random.uniform(0.2, 0.6);
+            for (int k = 0; k < Harmonics; ++k) {
+                amplitude[k] = random.uniform(0.0, 0.15);
+                aroundMajor[k] = std::floor(random.uniform(1.0, 12.0));
+                aroundMinor[k] = std::floor(random.uniform(1.0, 6.0));
+                phase[k] = random.uniform(0.0, 2.0 * Pi);
+            }
+        }
+
+        /**
+         * @brief Surface point for grid position (i, j) of a u by v grid. Shared
+         * vertices are computed from the same integers, so they weld exactly.
+         */
+        void point(std::uint64_t i, std::uint64_t j, std::uint64_t u, std::uint64_t v, const float offset[3], float out[3]) const {
+            const double theta = 2.0 * Pi * double(i % u) / double(u);
+            const double phi = 2.0 * Pi * double(j % v) / double(v);
+
+            double r = minorRadius;
+            for (int k = 0; k < Harmonics; ++k)
+                r += minorRadius * amplitude[k] * std::sin(aroundMajor[k] * theta + phase[k]) * std::cos(aroundMinor[k] * phi);
+
+            const double ring = majorRadius + r * std::cos(phi);
+            out[0] = offset[0] + static_cast<float>(ring * std::cos(theta));
+            out[1] = offset[1] + static_cast<float>(ring * std::sin(theta));
+            out[2] = offset[2] + static_cast<float>(r * std::sin(phi));
+        }
+    };
+
+    void setError(std::string* error, const std::string& message) {
+        if (error)
+            *error = message;
+    }
+
+    void appendBytes(std::vector<char>& buffer, const void* data, size_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+
+    /**
+     * @brief Streams the torus to disk a megabyte at a time, so memory use does not
+     * depend on the triangle count.
+     */
+    bool writeMesh(const std::string& path, std::uint64_t triangles, std::uint64_t seed,
+                   const float offset[3], STLFormat format, std::string* error) {
+        if (triangles == 0 || (format == STLFormat::Binary && triangles > 0xFFFFFFFFull)) {
+            setError(error, "Triangle count out of range for " + path);
+            return false;
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            setError(error, "Cannot open " + path);
+            return false;
+        }
+
+        const Shape shape(seed);
+
+        // Quads around the minor circle, sized so the cells come out roughly square
+        const std::uint64_t quads = (triangles + 1) / 2;
+        const double aspect = shape.majorRadius / shape.minorRadius;
+        const std::uint64_t v = std::max<std::uint64_t>(3, static_cast<std::uint64_t>(std::llround(std::sqrt(quads / aspect))));
+        const std::uint64_t u = std::max<std::uint64_t>(3, (quads + v - 1) / v);
+
+        char name[96];
+        std::snprintf(name, sizeof(name), "vrcad_synthetic_%llu_%llu",
+                      static_cast<unsigned long long>(seed), static_cast<unsigned long long>(triangles));
+
+        std::vector<char> buffer;
+        buffer.reserve(1 << 20);
+
+        if (format == STLFormat::Binary) {
+            // The header must not start with "solid", which marks ASCII files
+            char header[80] = {};
+            std::snprintf(header, sizeof(header), "VRCAD synthetic STL %s", name);
+            appendBytes(buffer, header, sizeof(header));
+            const std::uint32_t count = static_cast<std::uint32_t>(triangles);
+            unsigned char little[4] = { static_cast<unsigned char>(count), static_cast<unsigned char>(count >> 8),
+                                        static_cast<unsigned char>(count >> 16), static_cast<unsigned char>(count >> 24) };
+            appendBytes(buffer, little, sizeof(little));
+        }
+        else {
+            buffer.insert(buffer.end(), "solid ", "solid " + 6);
+            appendBytes(buffer, name, std::strlen(name));
+            buffer.push_back('\n');
+        }
+
+        std::uint64_t written = 0;
+        for (std::uint64_t i = 0; i < u && written < triangles; ++i) {
+            for (std::uint64_t j = 0; j < v && written < triangles; ++j) {
+                float corner[4][3];
+                shape.point(i, j, u, v, offset, corner[0]);
+                shape.point(i + 1, j, u, v, offset, corner[1]);
+                shape.point(i + 1, j + 1, u, v, offset, corner[2]);
+                shape.point(i, j + 1, u, v, offset, corner[3]);
+
+                const int order[2][3] = { { 0, 1, 2 }, { 0, 2, 3 } };
+                for (int t = 0; t < 2 && written < triangles; ++t, ++written) {
+                    const float* a = corner[order[t][0]];
+                    const float* b = corner[order[t][1]];
+                    const float* c = corner[order[t][2]];
+
+                    float normal[3] = {
+                        (b[1] - a[1]) * (c[2] - a[2]) - (b[2] - a[2]) * (c[1] - a[1]),
+                        (b[2] - a[2]) * (c[0] - a[0]) - (b[0] - a[0]) * (c[2] - a[2]),
+                        (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]),
+                    };
+                    const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (length > 0.0f) {
+                        for (float& n : normal)
+                            n /= length;
+                    }
+
+                    if (format == STLFormat::Binary) {
+                        float record[12];
+                        std::memcpy(record, normal, sizeof(normal));
+                        std::memcpy(record + 3, a, 3 * sizeof(float));
+                        std::memcpy(record + 6, b, 3 * sizeof(float));
+                        std::memcpy(record + 9, c, 3 * sizeof(float));
+                        appendBytes(buffer, record, sizeof(record));
+                        buffer.push_back(0);
+                        buffer.push_back(0);
+                    }
+                    else {
+                        char facet[512];
+                        const int length = std::snprintf(facet, sizeof(facet),
+                            " facet normal %.7e %.7e %.7e\n  outer loop\n"
+                            "   vertex %.7e %.7e %.7e\n   vertex %.7e %.7e %.7e\n   vertex %.7e %.7e %.7e\n"
+                            "  endloop\n endfacet\n",
+                            normal[0], normal[1], normal[2], a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2]);
+                        appendBytes(buffer, facet, static_cast<size_t>(length));
+                    }
+                }
+
+                if (buffer.size() >= (1 << 20)) {
+                    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+                    buffer.clear();
+                }
+            }
+        }
+
+        if (format == STLFormat::Ascii) {
+            buffer.insert(buffer.end(), "endsolid ", "endsolid " + 9);
+            appendBytes(buffer, name, std::strlen(name));
+            buffer.push_back('\n');
+        }
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        file.close();
+
+        if (!file) {
+            setError(error, "Failed writing " + path);
+            return false;
+        }
+        return true;
+    }
+}
+
+bool WriteSyntheticSTL(const std::string& path, std::uint64_t triangles, std::uint64_t seed,
+                       STLFormat format, std::string* error) {
+    const float origin[3] = { 0.0f, 0.0f, 0.0f };
+    return writeMesh(path, triangles, seed, origin, format, error);
+}
+
+/**
+ * @brief Draws every choice up front from one sequence, then writes each unique part
+ * once and copies it for its duplicates.
+ */
+bool WriteSyntheticAssembly(const std::string& directory, const AssemblySpec& spec,
+                            AssemblyReport& report, std::string* error) {
+    report = AssemblyReport();
+    if (spec.parts < 1 || spec.minTriangles < 1 || spec.maxTriangles < spec.minTriangles
+        || spec.duplicateRatio < 0.0 || spec.duplicateRatio > 1.0 || spec.depth < 0 || spec.fanout < 1) {
+        setError(error, "Invalid assembly settings");
+        return false;
+    }
+
+    std::error_code code;
+    fs::create_directories(directory, code);
+    if (code) {
+        setError(error, "Cannot create " + directory + ": " + code.message());
+        return false;
+    }
+
+    Random random(spec.seed);
+
+    // Unique geometry: a log-uniform size, a shape seed and a grid cell each
+    const int unique = std::max(1, spec.parts - static_cast<int>(std::llround(spec.parts * spec.duplicateRatio)));
+    const int gridSide = std::max(1, static_cast<int>(std::ceil(std::cbrt(double(unique)))));
+    const double spacing = 6.5;
+
+    struct Geometry {
+        std::uint64_t triangles;
+        std::uint64_t seed;
+        float offset[3];
+        std::string firstPath;
+    };
+    std::vector<Geometry> geometries(unique);
+    const double logMin = std::log(double(spec.minTriangles));
+    const double logMax = std::log(double(spec.maxTriangles));
+    for (int k = 0; k < unique; ++k) {
+        Geometry& geometry = geometries[k];
+        geometry.triangles = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::llround(std::exp(random.uniform(logMin, logMax)))));
+        geometry.triangles = std::min(std::max(geometry.triangles, spec.minTriangles), spec.maxTriangles);
+        geometry.seed = random.next();
+        geometry.offset[0] = static_cast<float>(spacing * (k % gridSide));
+        geometry.offset[1] = static_cast<float>(spacing * ((k / gridSide) % gridSide));
+        geometry.offset[2] = static_cast<float>(spacing * (k / (gridSide * gridSide)));
+    }
+
+    // Every geometry appears at least once; the rest are duplicates. Shuffled so
+    // repeats are spread through the assembly rather than all at the end
+    std::vector<int> geometryOf(spec.parts);
+    for (int i = 0; i < spec.parts; ++i)
+        geometryOf[i] = i < unique ? i : static_cast<int>(random.next() % unique);
+    for (int i = spec.parts - 1; i > 0; --i)
+        std::swap(geometryOf[i], geometryOf[random.next() % (i + 1)]);
+
+    std::ofstream manifest(fs::path(directory) / "assembly.txt", std::ios::trunc);
+    if (!manifest) {
+        setError(error, "Cannot write the assembly manifest in " + directory);
+        return false;
+    }
+    manifest << "# VRCAD synthetic assembly: seed " << spec.seed << ", " << spec.parts << " parts, "
+             << unique << " unique\n";
+
+    const char* extension = spec.format == STLFormat::Binary ? ".stl" : "_ascii.stl";
+    for (int i = 0; i < spec.parts; ++i) {
+        fs::path relative;
+        for (int level = 0; level < spec.depth; ++level) {
+            char group[32];
+            std::snprintf(group, sizeof(group), "group_%02d", static_cast<int>(random.next() % spec.fanout));
+            relative /= group;
+        }
+        char file[48];
+        std::snprintf(file, sizeof(file), "part_%06d%s", i, extension);
+        relative /= file;
+
+        const fs::path path = fs::path(directory) / relative;
+        fs::create_directories(path.parent_path(), code);
+
+        Geometry& geometry = geometries[geometryOf[i]];
+        if (geometry.firstPath.empty()) {
+            if (!writeMesh(path.string(), geometry.triangles, geometry.seed, geometry.offset, spec.format, error))
+                return false;
+            geometry.firstPath = path.string();
+            report.uniqueParts++;
+        }
+        else if (!fs::copy_file(geometry.firstPath, path, fs::copy_options::overwrite_existing, code)) {
+            setError(error, "Cannot copy to " + path.string() + ": " + code.message());
+            return false;
+        }
+
+        report.parts++;
+        report.triangles += geometry.triangles;
+        report.bytes += fs::file_size(path, code);
+        manifest << relative.generic_string() << '\n';
+    }
+
+    if (!manifest.flush()) {
+        setError(error, "Failed writing the assembly manifest in " + directory);
+        return false;
+    }
+    return true;
+}
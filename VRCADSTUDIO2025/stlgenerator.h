@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @file
+ * This file contains the synthetic STL generator used to reproduce performance
+ * problems without customer models. It only uses the standard library, and the
+ * output depends on nothing but the seed and the settings.
+ */
+
+/**
+ * @brief STL encodings the generator can write.
+ */
+enum class STLFormat {
+    Binary,  /**< 50 bytes per triangle */
+    Ascii    /**< Text facets, several times larger and slower to parse */
+};
+
+/**
+ * @brief Writes one closed-looking rippled torus with exactly the given number of triangles.
+ *
+ * The shape (radii, ripples and placement) is drawn from the seed, so the same seed
+ * and count always give byte-identical files.
+ *
+ * @param path File to write. It is replaced if it exists.
+ * @param triangles Number of triangles, at least 1.
+ * @param seed Seed for the shape.
+ * @param format Binary or ASCII STL.
+ * @param error Receives a message if writing fails. May be null.
+ * @return false if the file could not be written.
+ */
+bool WriteSyntheticSTL(const std::string& path, std::uint64_t triangles, std::uint64_t seed,
+                       STLFormat format, std::string* error = nullptr);
+
+/**
+ * @brief Settings for a generated assembly directory.
+ */
+struct AssemblySpec {
+    int parts = 100;                        /**< Number of part files */
+    std::uint64_t minTriangles = 1000;      /**< Smallest unique part */
+    std::uint64_t maxTriangles = 100000;    /**< Largest unique part */
+    double duplicateRatio = 0.0;            /**< Fraction of parts that repeat an earlier part's file contents */
+    int depth = 0;                          /**< Levels of subdirectories the parts are spread over */
+    int fanout = 4;                         /**< Subdirectories per level */
+    std::uint64_t seed = 1;                 /**< Seed for every random choice */
+    STLFormat format = STLFormat::Binary;   /**< Encoding of every file */
+};
+
+/**
+ * @brief What a generated assembly contains.
+ */
+struct AssemblyReport {
+    int parts = 0;                   /**< Part files written */
+    int uniqueParts = 0;             /**< Parts with geometry of their own */
+    std::uint64_t triangles = 0;     /**< Triangles over all parts */
+    std::uint64_t bytes = 0;         /**< Size of all part files */
+};
+
+/**
+ * @brief Writes a directory of part files plus an assembly.txt listing them in order.
+ *
+ * Unique parts get triangle counts spread log-uniformly between the minimum and
+ * maximum and are laid out on a grid so they do not overlap. Duplicates are
+ * byte-identical copies of an earlier part, like the repeated fasteners of a real
+ * assembly. With a depth above zero, parts are spread over nested subdirectories.
+ *
+ * @param directory Directory to write into. Created if needed.
+ * @param spec What to generate.
+ * @param report Receives the totals.
+ * @param error Receives a message if writing fails. May be null.
+ * @return false if any file could not be written.
+ */
+bool WriteSyntheticAssembly(const std::string& directory, const AssemblySpec& spec,
+                            AssemblyReport& report, std::string* error = nullptr);
@@ -0,0 +1,81 @@
+#include "stlloader.h"
+#include "ModelPart.h"
+#include "profiler.h"
+
+#include <QThread>
+
+/**
+ * @brief Constructs the loader with one worker per available core.
+ */
+STLLoader::STLLoader(QObject* parent)
+    : QObject(parent)
+{
+    pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+/**
+ * @brief Drops files that have not started and waits for the running ones.
+ *
+ * Results posted by the running workers are discarded by Qt once this object is gone.
+ */
+STLLoader::~STLLoader() {
+    pool.clear();
+    pool.waitForDone();
+}
+
+/**
+ * @brief Queues each file on the worker pool.
+ */
+void STLLoader::load(const QStringList& fileNames, const QList<QPersistentModelIndex>& parts) {
+    if (!isLoading()) {
+        total = 0;
+        done = 0;
+        failed = 0;
+    }
+    total += fileNames.size();
+
+    for (int i = 0; i < fileNames.size(); ++i) {
+        const QString fileName = fileNames.at(i);
+
+        // Persistent indexes belong to the GUI thread, so the worker only carries a ticket
+        const quint64 ticket = ++nextTicket;
+        pending.insert(ticket, parts.value(i));
+
+        pool.start([this, fileName, ticket]() {
+            if (Tracer::isEnabled())
+                Tracer::instance().setThreadName("STL loader");
+
+            vtkSmartPointer<vtkPolyData> data = ModelPart::readSTL(fileName);
+
+            // Hand the result back to the thread that owns the loader
+            QMetaObject::invokeMethod(this, [this, fileName, data, ticket]() {
+                deliver(fileName, data, ticket);
+            }, Qt::QueuedConnection);
+        });
+    }
+}
+
+bool STLLoader::isLoading() const {
+    return done < total;
+}
+
+/**
+ * @brief Emits the result for one file and the batch summary once all are in.
+ */
+void STLLoader::deliver(const QString& fileName, vtkSmartPointer<vtkPolyData> data, quint64 ticket) {
+    const QPersistentModelIndex part = pending.take(ticket);
+    done++;
+
+    if (data) {
+        emit fileLoaded(fileName, data, part);
+    }
+    else {
+        failed++;
+        emit fileFailed(fileName, part);
+    }
+
+    emit progress(done, total);
+
+    if (done == total)
+        emit finished(total - failed, failed);
+}
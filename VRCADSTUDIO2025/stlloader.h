@@ -0,0 +1,102 @@
+#ifndef STL_LOADER_H
+#define STL_LOADER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QThreadPool>
+#include <QPersistentModelIndex>
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file
+ * This file contains the declaration of the STLLoader class, which parses
+ * STL files on a pool of worker threads.
+ */
+
+ /**
+  * @class STLLoader
+  * @brief Parses STL files in the background and hands the results back to the GUI thread.
+  *
+  * Each file is parsed by ModelPart::readSTL() on its own worker, using one worker per core.
+  * Files already in the GeometryCache are read back from it instead of being parsed.
+  * The parsed poly data is delivered through fileLoaded() on the thread that owns the
+  * loader, so the receiver can create actors and update tree items without locking.
+  * Tree items are only ever touched on that thread; workers carry a plain ticket.
+  */
+class STLLoader : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructs the loader with one worker per available core.
+     * @param parent Parent QObject.
+     */
+    explicit STLLoader(QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor. Drops queued files and waits for running workers.
+     */
+    ~STLLoader() override;
+
+    /**
+     * @brief Queues files for parsing.
+     * @param fileNames STL files to parse.
+     * @param parts Tree item each file's geometry is delivered to, one per file.
+     */
+    void load(const QStringList& fileNames, const QList<QPersistentModelIndex>& parts);
+
+    /**
+     * @brief Returns whether any queued file has not been delivered yet.
+     */
+    bool isLoading() const;
+
+signals:
+    /**
+     * @brief Emitted on the loader's thread when a file has been parsed.
+     * @param fileName The file that was parsed.
+     * @param data The parsed geometry.
+     * @param part Tree item passed to load() for this file.
+     */
+    void fileLoaded(const QString& fileName, vtkSmartPointer<vtkPolyData> data, const QPersistentModelIndex& part);
+
+    /**
+     * @brief Emitted when a file could not be parsed.
+     * @param fileName The file that failed.
+     * @param part Tree item passed to load() for this file.
+     */
+    void fileFailed(const QString& fileName, const QPersistentModelIndex& part);
+
+    /**
+     * @brief Emitted after each file is delivered.
+     * @param done Number of files delivered so far.
+     * @param total Number of files queued in the current batch.
+     */
+    void progress(int done, int total);
+
+    /**
+     * @brief Emitted when every queued file has been delivered.
+     * @param loaded Number of files parsed successfully.
+     * @param failed Number of files that could not be parsed.
+     */
+    void finished(int loaded, int failed);
+
+private:
+    /**
+     * @brief Receives a parsed file on the loader's thread.
+     */
+    void deliver(const QString& fileName, vtkSmartPointer<vtkPolyData> data, quint64 ticket);
+
+    QThreadPool pool;   /**< Worker threads used for parsing */
+    QHash<quint64, QPersistentModelIndex> pending;  /**< Tree item per queued file, by ticket */
+    quint64 nextTicket = 0;                         /**< Ticket for the next queued file */
+    int total = 0;      /**< Files queued in the current batch */
+    int done = 0;       /**< Files delivered in the current batch */
+    int failed = 0;     /**< Files in the current batch that failed */
+};
+
+#endif // STL_LOADER_H
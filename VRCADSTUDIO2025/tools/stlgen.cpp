@@ -0,0 +1,160 @@
+// stlgen.cpp
+//
+// Writes synthetic STL parts and assemblies for reproducing performance problems
+// without customer models. The output depends only on the arguments, so the same
+// command gives the same files on every machine.
+//
+//   stlgen mesh -o part.stl --triangles 1000000 [--seed 7] [--ascii]
+//   stlgen assembly -o dir --parts 5000 --min-triangles 1000 --max-triangles 200000
+//          --duplicates 0.6 --depth 3 [--fanout 4] [--seed 7] [--ascii]
+
+#include "stlgenerator.h"
+
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace {
+    void usage() {
+        std::fprintf(stderr,
+            "usage: stlgen mesh -o FILE --triangles N [--seed S] [--ascii]\n"
+            "       stlgen assembly -o DIR --parts N [--min-triangles N] [--max-triangles N]\n"
+            "              [--duplicates RATIO] [--depth D] [--fanout F] [--seed S] [--ascii]\n");
+    }
+
+    bool parseNumber(const char* text, double& value) {
+        char* end = nullptr;
+        const double parsed = std::strtod(text, &end);
+        if (end == text || *end != '\0' || !std::isfinite(parsed))
+            return false;
+        value = parsed;
+        return true;
+    }
+
+    bool parseCount(const char* text, std::uint64_t& value) {
+        // Plain integers are parsed exactly, so seeds keep all 64 bits
+        if (*text >= '0' && *text <= '9') {
+            char* end = nullptr;
+            errno = 0;
+            const unsigned long long parsed = std::strtoull(text, &end, 10);
+            if (*end == '\0') {
+                value = parsed;
+                return errno != ERANGE;
+            }
+        }
+
+        double parsed = 0;  // accepts 1e6 as well as 1000000
+        if (!parseNumber(text, parsed) || parsed < 0 || parsed != std::floor(parsed))
+            return false;
+        // 2^64 is exact as a double; anything from there up does not fit
+        if (parsed >= 18446744073709551616.0)
+            return false;
+        value = static_cast<std::uint64_t>(parsed);
+        return true;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage();
+        return 2;
+    }
+    const std::string mode = argv[1];
+    if (mode != "mesh" && mode != "assembly") {
+        usage();
+        return 2;
+    }
+
+    std::string output;
+    std::uint64_t triangles = 0;
+    AssemblySpec spec;
+
+    for (int i = 2; i < argc; ++i) {
+        const std::string option = argv[i];
+        if (option == "--ascii") {
+            spec.format = STLFormat::Ascii;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "Missing value for %s\n", option.c_str());
+            return 2;
+        }
+        const char* value = argv[++i];
+
+        std::uint64_t number = 0;
+        bool ok = true;
+        if (option == "-o" || option == "--output")
+            output = value;
+        else if (option == "--triangles")
+            ok = parseCount(value, triangles);
+        else if (option == "--seed")
+            ok = parseCount(value, spec.seed);
+        else if (option == "--parts") {
+            ok = parseCount(value, number) && number >= 1 && number <= 10000000;
+            spec.parts = static_cast<int>(number);
+        }
+        else if (option == "--min-triangles")
+            ok = parseCount(value, spec.minTriangles);
+        else if (option == "--max-triangles")
+            ok = parseCount(value, spec.maxTriangles);
+        else if (option == "--duplicates")
+            ok = parseNumber(value, spec.duplicateRatio) && spec.duplicateRatio >= 0.0 && spec.duplicateRatio <= 1.0;
+        else if (option == "--depth") {
+            ok = parseCount(value, number) && number <= 32;
+            spec.depth = static_cast<int>(number);
+        }
+        else if (option == "--fanout") {
+            ok = parseCount(value, number) && number >= 1 && number <= 100;
+            spec.fanout = static_cast<int>(number);
+        }
+        else {
+            std::fprintf(stderr, "Unknown option %s\n", option.c_str());
+            usage();
+            return 2;
+        }
+
+        if (!ok) {
+            std::fprintf(stderr, "Invalid value %s for %s\n", value, option.c_str());
+            return 2;
+        }
+    }
+
+    if (output.empty()) {
+        usage();
+        return 2;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    auto seconds = [&start]() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    std::string error;
+    if (mode == "mesh") {
+        if (triangles == 0) {
+            std::fprintf(stderr, "--triangles is required\n");
+            return 2;
+        }
+        if (!WriteSyntheticSTL(output, triangles, spec.seed, spec.format, &error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        std::printf("%s: %llu triangles in %.2f s\n", output.c_str(),
+                    static_cast<unsigned long long>(triangles), seconds());
+        return 0;
+    }
+
+    AssemblyReport report;
+    if (!WriteSyntheticAssembly(output, spec, report, &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    std::printf("%s: %d parts (%d unique), %llu triangles, %.1f MB in %.2f s\n", output.c_str(),
+                report.parts, report.uniqueParts, static_cast<unsigned long long>(report.triangles),
+                report.bytes / (1024.0 * 1024.0), seconds());
+    return 0;
+}
@@ -0,0 +1,19 @@
+// vrcad_headless.cpp
+//
+// Offscreen batch renderer built on vrcad_core alone, so it configures and links on
+// machines without Qt Widgets or a VTK built with OpenVR. It takes the same arguments
+// as VRCADSTUDIO2025 --headless; --headless itself is accepted and ignored.
+//
+//   vrcad_headless -o review.png --size 3840x2160 --clip part1.stl part2.stl
+
+#include "headless.h"
+
+#include <QCoreApplication>
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    HeadlessOptions options;
+    if (!ParseHeadlessArguments(app, options))
+        return 2;
+    return RunHeadless(options);
+}
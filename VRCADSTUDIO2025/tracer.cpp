@@ -0,0 +1,238 @@
+#include "tracer.h"
+#include "profiler.h"
+
+#include <QCoreApplication>
+#include <QByteArray>
+
+#include <chrono>
+
+std::atomic<bool> Tracer::enabled{ false };
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::~Tracer() {
+    stop();
+}
+
+Tracer::ThreadBuffer::~ThreadBuffer() {
+    while (head) {
+        Chunk* next = head->next.load(std::memory_order_acquire);
+        delete head;
+        head = next;
+    }
+}
+
+bool Tracer::ThreadBuffer::drained() const {
+    return head == tail && read == head->count.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief Retires the buffer. It is recycled straight away if nothing is left to flush,
+ * otherwise by the flush that writes its last events.
+ */
+Tracer::BufferHandle::~BufferHandle() {
+    if (!buffer)
+        return;
+
+    Tracer& tracer = Tracer::instance();
+    QMutexLocker locker(&tracer.mutex);
+    buffer->retired = true;
+    tracer.recycle(buffer);
+}
+
+void Tracer::recycle(ThreadBuffer* buffer) {
+    if (!buffer->retired || buffer->recycled || !buffer->drained())
+        return;
+    buffer->recycled = true;
+    freeBuffers.push_back(buffer);
+}
+
+/**
+ * @brief Writes the JSON header, drops events left over from an earlier trace and
+ * starts the flush thread.
+ */
+bool Tracer::start(const QString& fileName) {
+    QMutexLocker locker(&mutex);
+    if (file.isOpen())
+        return false;
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    file.write("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    firstEvent = true;
+
+    // Anything still buffered was recorded while the previous trace was stopping
+    for (const auto& buffer : buffers) {
+        if (buffer->recycled)
+            continue;
+        buffer->named = false;
+        while (Chunk* chunk = buffer->head) {
+            buffer->read = chunk->count.load(std::memory_order_acquire);
+            Chunk* next = buffer->read == ChunkSize ? chunk->next.load(std::memory_order_acquire) : nullptr;
+            if (!next)
+                break;
+            delete chunk;
+            buffer->head = next;
+            buffer->read = 0;
+        }
+        recycle(buffer.get());
+    }
+
+    origin = Profiler::now();
+    flushing.store(true);
+    flusher = std::thread(&Tracer::flushLoop, this);
+    enabled.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Stops the flush thread first so the final flush below is the only reader.
+ */
+void Tracer::stop() {
+    enabled.store(false, std::memory_order_relaxed);
+    if (!flusher.joinable())
+        return;
+
+    flushing.store(false);
+    flusher.join();
+    flush();
+
+    QMutexLocker locker(&mutex);
+    file.write("\n]}\n");
+    file.close();
+}
+
+QString Tracer::fileName() const {
+    QMutexLocker locker(&mutex);
+    return file.isOpen() ? file.fileName() : QString();
+}
+
+void Tracer::setThreadName(const char* name) {
+    localBuffer()->name.store(name, std::memory_order_release);
+}
+
+/**
+ * @brief Each thread looks its buffer up once; the lock is only taken to take one
+ * from the free list or register a new one.
+ *
+ * A reused buffer gets a new id and no name, so the new thread has its own track.
+ */
+Tracer::ThreadBuffer* Tracer::localBuffer() {
+    thread_local BufferHandle handle;
+    if (!handle.buffer) {
+        QMutexLocker locker(&mutex);
+        ThreadBuffer* buffer;
+        if (!freeBuffers.empty()) {
+            buffer = freeBuffers.back();
+            freeBuffers.pop_back();
+            buffer->name.store(nullptr, std::memory_order_relaxed);
+            buffer->named = false;
+            buffer->retired = false;
+            buffer->recycled = false;
+        }
+        else {
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->head = buffer->tail = new Chunk;
+        }
+        buffer->id = ++nextThreadId;
+        handle.buffer = buffer;
+    }
+    return handle.buffer;
+}
+
+/**
+ * @brief Publishes the event by bumping the chunk's count, starting a new chunk when
+ * the current one is full.
+ */
+void Tracer::append(const char* name, char phase) {
+    ThreadBuffer* buffer = localBuffer();
+    Chunk* chunk = buffer->tail;
+    int count = chunk->count.load(std::memory_order_relaxed);
+
+    if (count == ChunkSize) {
+        Chunk* fresh = new Chunk;
+        chunk->next.store(fresh, std::memory_order_release);
+        buffer->tail = chunk = fresh;
+        count = 0;
+    }
+
+    chunk->events[count] = { name, Profiler::now(), phase };
+    chunk->count.store(count + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Quotes a name for JSON.
+ */
+static QByteArray jsonString(const char* text) {
+    QByteArray quoted = "\"";
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\')
+            quoted += '\\';
+        quoted += *c;
+    }
+    return quoted + '"';
+}
+
+/**
+ * @brief A chunk is only freed once the recording thread has moved on to the next one.
+ */
+void Tracer::flush() {
+    const QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray out;
+
+    auto add = [this, &out](const QByteArray& event) {
+        if (!firstEvent)
+            out += ",\n";
+        firstEvent = false;
+        out += event;
+    };
+
+    QMutexLocker locker(&mutex);
+    for (const auto& buffer : buffers) {
+        if (buffer->recycled)
+            continue;
+        const QByteArray tid = QByteArray::number(buffer->id);
+
+        const char* name = buffer->name.load(std::memory_order_acquire);
+        if (name && !buffer->named) {
+            add("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + pid + ",\"tid\":" + tid
+                + ",\"args\":{\"name\":" + jsonString(name) + "}}");
+            buffer->named = true;
+        }
+
+        while (Chunk* chunk = buffer->head) {
+            const int count = chunk->count.load(std::memory_order_acquire);
+            for (; buffer->read < count; ++buffer->read) {
+                const Event& event = chunk->events[buffer->read];
+                const double us = (event.time - origin) / 1000.0;
+                add("{\"name\":" + jsonString(event.name) + ",\"ph\":\"" + event.phase + "\",\"pid\":"
+                    + pid + ",\"tid\":" + tid + ",\"ts\":" + QByteArray::number(us, 'f', 3) + "}");
+            }
+
+            if (count < ChunkSize)
+                break;
+            Chunk* next = chunk->next.load(std::memory_order_acquire);
+            if (!next)
+                break;
+            delete chunk;
+            buffer->head = next;
+            buffer->read = 0;
+        }
+        recycle(buffer.get());
+    }
+    file.write(out);
+    file.flush();
+}
+
+void Tracer::flushLoop() {
+    setThreadName("Trace flush");
+    while (flushing.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        flush();
+    }
+}
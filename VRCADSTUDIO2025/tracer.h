@@ -0,0 +1,175 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QString>
+#include <QFile>
+#include <QMutex>
+#include <QtGlobal>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * @file
+ * This file contains the timeline tracer, which writes begin/end events from every
+ * thread to a Chrome trace JSON file that can be opened in Perfetto or chrome://tracing.
+ */
+
+ /**
+  * @class Tracer
+  * @brief Records begin/end events per thread and streams them to a trace file.
+  *
+  * Each thread appends to its own chain of fixed-size chunks without locking. A
+  * background thread drains the chunks every few milliseconds and writes them out,
+  * so events are never dropped and the recording threads never touch the file.
+  * When tracing is off, recording costs a single relaxed atomic load.
+  *
+  * When a thread exits its buffer is retired. Once its events have been flushed it
+  * goes to a free list and is reused, under a new thread id, by the next new thread.
+  */
+class Tracer {
+public:
+    /**
+     * @brief Returns the tracer shared by the whole application.
+     */
+    static Tracer& instance();
+
+    /**
+     * @brief Returns whether events are being recorded.
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Opens a trace file and starts recording and the background flush.
+     * @param fileName File to write. It is replaced if it exists.
+     * @return false if tracing is already running or the file could not be opened.
+     */
+    bool start(const QString& fileName);
+
+    /**
+     * @brief Stops recording, writes the remaining events and closes the file.
+     */
+    void stop();
+
+    /**
+     * @brief Returns the file being written, or an empty string when not tracing.
+     */
+    QString fileName() const;
+
+    /**
+     * @brief Names the calling thread in the trace.
+     * @param name Thread name. Must be a string literal or otherwise outlive the tracer.
+     */
+    void setThreadName(const char* name);
+
+    /**
+     * @brief Records the start of a named span on the calling thread.
+     * @param name Span name. Must be a string literal or otherwise outlive the tracer.
+     */
+    void begin(const char* name) { append(name, 'B'); }
+
+    /**
+     * @brief Records the end of the span most recently begun on the calling thread.
+     * @param name Span name, matching the one given to begin().
+     */
+    void end(const char* name) { append(name, 'E'); }
+
+    ~Tracer();
+
+private:
+    Tracer() = default;
+
+    static const int ChunkSize = 1024;  /**< Events per chunk */
+
+    /**
+     * @brief One begin or end event.
+     */
+    struct Event {
+        const char* name;  /**< Span name */
+        qint64 time;       /**< Profiler::now() timestamp */
+        char phase;        /**< 'B' or 'E' */
+    };
+
+    /**
+     * @brief Block of events written by one thread and read by the flush thread.
+     */
+    struct Chunk {
+        Event events[ChunkSize];                   /**< Events, valid up to count */
+        std::atomic<int> count{ 0 };               /**< Events published so far */
+        std::atomic<Chunk*> next{ nullptr };       /**< Chunk started once this one filled */
+    };
+
+    /**
+     * @brief Chunk chain owned by one thread.
+     *
+     * The recording thread only touches tail, the flush thread only head and read.
+     */
+    struct ThreadBuffer {
+        int id = 0;                                /**< Trace thread id */
+        std::atomic<const char*> name{ nullptr };  /**< Name set by setThreadName() */
+        bool named = false;                        /**< Name already written to the file */
+        bool retired = false;                      /**< Owning thread has exited, guarded by the mutex */
+        bool recycled = false;                     /**< Drained and on the free list, guarded by the mutex */
+        Chunk* head = nullptr;                     /**< Oldest chunk not yet fully flushed */
+        int read = 0;                              /**< Events of head already flushed */
+        Chunk* tail = nullptr;                     /**< Chunk being written */
+        ~ThreadBuffer();
+
+        /**
+         * @brief Returns whether every event has been flushed. Only valid once retired.
+         */
+        bool drained() const;
+    };
+
+    /**
+     * @brief Retires a thread's buffer when the thread exits.
+     */
+    struct BufferHandle {
+        ThreadBuffer* buffer = nullptr;
+        ~BufferHandle();
+    };
+
+    /**
+     * @brief Adds an event to the calling thread's buffer.
+     */
+    void append(const char* name, char phase);
+
+    /**
+     * @brief Returns the calling thread's buffer, taking one on first use.
+     */
+    ThreadBuffer* localBuffer();
+
+    /**
+     * @brief Moves a retired buffer whose events have all been flushed to the free list.
+     *
+     * Mutex must be held.
+     */
+    void recycle(ThreadBuffer* buffer);
+
+    /**
+     * @brief Writes every published event to the file and frees flushed chunks.
+     *
+     * Only called by the flush thread, or by stop() after it has finished.
+     */
+    void flush();
+
+    /**
+     * @brief Body of the background flush thread.
+     */
+    void flushLoop();
+
+    static std::atomic<bool> enabled;            /**< Whether events record */
+    std::atomic<bool> flushing{ false };         /**< Keeps the flush thread running */
+    mutable QMutex mutex;                        /**< Guards buffers, freeBuffers and the file */
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers; /**< Every buffer, in use, retired or free */
+    std::vector<ThreadBuffer*> freeBuffers;      /**< Drained buffers of exited threads, reused first */
+    int nextThreadId = 0;                        /**< Last trace thread id handed out */
+    QFile file;                                  /**< Trace being written */
+    qint64 origin = 0;                           /**< Timestamp of start(), time zero in the trace */
+    bool firstEvent = true;                      /**< No comma before the next event */
+    std::thread flusher;                         /**< Background flush thread */
+};
+
+#endif // TRACER_H
@@ -0,0 +1,214 @@
+#include "vertexweld.h"
+
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Integer key for a point: the float bit patterns, or grid cell indices with a tolerance.
+     */
+    struct WeldKey {
+        std::int64_t k[3];
+
+        bool operator==(const WeldKey& other) const {
+            return k[0] == other.k[0] && k[1] == other.k[1] && k[2] == other.k[2];
+        }
+    };
+
+    WeldKey makeKey(const float* p, double tolerance) {
+        WeldKey key;
+        for (int i = 0; i < 3; ++i) {
+            if (tolerance > 0.0) {
+                key.k[i] = static_cast<std::int64_t>(std::floor(p[i] / tolerance));
+            }
+            else {
+                // Adding 0 turns -0.0f into +0.0f so both hash the same
+                const float v = p[i] + 0.0f;
+                std::uint32_t bits;
+                std::memcpy(&bits, &v, sizeof(bits));
+                key.k[i] = bits;
+            }
+        }
+        return key;
+    }
+
+    std::uint64_t mix(std::uint64_t h) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    std::uint64_t hashKey(const WeldKey& key) {
+        return mix(key.k[0] * 0x9e3779b97f4a7c15ULL ^ mix(key.k[1] + 0x632be59bd9b4e019ULL) ^ mix(key.k[2]) * 31);
+    }
+}
+
+/**
+ * @brief Welds coincident points in parallel hash buckets.
+ *
+ * 1. Hash every point (parallel).
+ * 2. Counting sort the point ids into buckets chosen from the top hash bits.
+ * 3. Deduplicate each bucket with its own open-addressing table (parallel over buckets).
+ * 4. Prefix sum the unique counts to give each bucket its range of output ids.
+ * 5. Write the unique points and remap the connectivity (parallel).
+ */
+vtkSmartPointer<vtkPolyData> WeldVertices(vtkPolyData* input, double tolerance) {
+    const vtkIdType numPoints = input->GetNumberOfPoints();
+    if (numPoints == 0 || !input->GetPolys())
+        return input;
+
+    // Work on float coordinates, converting only if the input is not float already
+    vtkSmartPointer<vtkFloatArray> coords = vtkFloatArray::FastDownCast(input->GetPoints()->GetData());
+    if (!coords) {
+        coords = vtkSmartPointer<vtkFloatArray>::New();
+        coords->DeepCopy(input->GetPoints()->GetData());
+    }
+    const float* pts = coords->GetPointer(0);
+
+    // 1. Hash
+    std::vector<std::uint64_t> hashes(numPoints);
+    vtkSMPTools::For(0, numPoints, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i)
+            hashes[i] = hashKey(makeKey(pts + 3 * i, tolerance));
+    });
+
+    // 2. Bucket - aim for a few thousand points per bucket, as a power of two
+    int bucketBits = 0;
+    while (bucketBits < 16 && (vtkIdType(1) << (bucketBits + 12)) < numPoints)
+        bucketBits++;
+    const vtkIdType numBuckets = vtkIdType(1) << bucketBits;
+    auto bucketOf = [bucketBits](std::uint64_t h) -> vtkIdType {
+        return bucketBits == 0 ? 0 : static_cast<vtkIdType>(h >> (64 - bucketBits));
+    };
+
+    std::vector<vtkIdType> bucketStart(numBuckets + 1, 0);
+    for (vtkIdType i = 0; i < numPoints; ++i)
+        bucketStart[bucketOf(hashes[i]) + 1]++;
+    for (vtkIdType b = 0; b < numBuckets; ++b)
+        bucketStart[b + 1] += bucketStart[b];
+
+    std::vector<vtkIdType> sorted(numPoints);
+    {
+        std::vector<vtkIdType> fill(bucketStart.begin(), bucketStart.end() - 1);
+        for (vtkIdType i = 0; i < numPoints; ++i)
+            sorted[fill[bucketOf(hashes[i])]++] = i;
+    }
+
+    // 3. Deduplicate each bucket. localId[i] is the bucket-local unique id of point i and
+    //    the first point of each unique key is kept as its representative.
+    std::vector<vtkIdType> localId(numPoints);
+    std::vector<vtkIdType> representatives(numPoints);
+    std::vector<vtkIdType> uniqueCount(numBuckets + 1, 0);
+
+    vtkSMPTools::For(0, numBuckets, [&](vtkIdType firstBucket, vtkIdType lastBucket) {
+        std::vector<vtkIdType> table;
+        for (vtkIdType b = firstBucket; b < lastBucket; ++b) {
+            const vtkIdType start = bucketStart[b];
+            const vtkIdType size = bucketStart[b + 1] - start;
+
+            vtkIdType capacity = 16;
+            while (capacity < 2 * size)
+                capacity <<= 1;
+            table.assign(capacity, -1);
+
+            vtkIdType unique = 0;
+            for (vtkIdType s = start; s < start + size; ++s) {
+                const vtkIdType id = sorted[s];
+                const WeldKey key = makeKey(pts + 3 * id, tolerance);
+
+                vtkIdType slot = static_cast<vtkIdType>(hashes[id] & (capacity - 1));
+                while (true) {
+                    const vtkIdType entry = table[slot];
+                    if (entry < 0) {
+                        // New key: representatives are stored in this bucket's own output range
+                        table[slot] = unique;
+                        representatives[start + unique] = id;
+                        localId[id] = unique++;
+                        break;
+                    }
+                    const vtkIdType other = representatives[start + entry];
+                    if (hashes[other] == hashes[id] && makeKey(pts + 3 * other, tolerance) == key) {
+                        localId[id] = entry;
+                        break;
+                    }
+                    slot = (slot + 1) & (capacity - 1);
+                }
+            }
+            uniqueCount[b + 1] = unique;
+        }
+    });
+
+    // 4. Prefix sum of unique points per bucket
+    for (vtkIdType b = 0; b < numBuckets; ++b)
+        uniqueCount[b + 1] += uniqueCount[b];
+    const vtkIdType numUnique = uniqueCount[numBuckets];
+
+    // 5. Write the unique points and the old-to-new point map
+    vtkNew<vtkFloatArray> weldedCoords;
+    weldedCoords->SetNumberOfComponents(3);
+    weldedCoords->SetNumberOfTuples(numUnique);
+    float* out = weldedCoords->GetPointer(0);
+
+    std::vector<vtkIdType> remap(numPoints);
+    vtkSMPTools::For(0, numBuckets, [&](vtkIdType firstBucket, vtkIdType lastBucket) {
+        for (vtkIdType b = firstBucket; b < lastBucket; ++b) {
+            const vtkIdType start = bucketStart[b];
+            const vtkIdType unique = uniqueCount[b + 1] - uniqueCount[b];
+            for (vtkIdType u = 0; u < unique; ++u)
+                std::copy(pts + 3 * representatives[start + u], pts + 3 * representatives[start + u] + 3,
+                          out + 3 * (uniqueCount[b] + u));
+            for (vtkIdType s = start; s < bucketStart[b + 1]; ++s)
+                remap[sorted[s]] = uniqueCount[b] + localId[sorted[s]];
+        }
+    });
+
+    // Remap the connectivity. Offsets are unchanged, so the input's offsets array is shared.
+    vtkCellArray* inputPolys = input->GetPolys();
+    vtkSmartPointer<vtkIdTypeArray> inputOffsets = vtkIdTypeArray::FastDownCast(inputPolys->GetOffsetsArray());
+    vtkSmartPointer<vtkIdTypeArray> inputConnectivity = vtkIdTypeArray::FastDownCast(inputPolys->GetConnectivityArray());
+    if (!inputOffsets || !inputConnectivity) {
+        inputOffsets = vtkSmartPointer<vtkIdTypeArray>::New();
+        inputOffsets->DeepCopy(inputPolys->GetOffsetsArray());
+        inputConnectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+        inputConnectivity->DeepCopy(inputPolys->GetConnectivityArray());
+    }
+
+    const vtkIdType connectivitySize = inputConnectivity->GetNumberOfValues();
+    const vtkIdType* oldIds = inputConnectivity->GetPointer(0);
+
+    vtkNew<vtkIdTypeArray> connectivity;
+    connectivity->SetNumberOfValues(connectivitySize);
+    vtkIdType* newIds = connectivity->GetPointer(0);
+
+    vtkSMPTools::For(0, connectivitySize, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i)
+            newIds[i] = remap[oldIds[i]];
+    });
+
+    vtkNew<vtkPoints> points;
+    points->SetData(weldedCoords);
+
+    vtkNew<vtkCellArray> polys;
+    polys->SetData(inputOffsets, connectivity);
+
+    vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+    output->SetPoints(points);
+    output->SetPolys(polys);
+    output->GetCellData()->ShallowCopy(input->GetCellData());
+
+    return output;
+}
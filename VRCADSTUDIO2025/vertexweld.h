@@ -0,0 +1,30 @@
+#ifndef VERTEX_WELD_H
+#define VERTEX_WELD_H
+
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+
+/**
+ * @file
+ * This file contains a hash-based vertex welding pass that turns STL triangle
+ * soup into indexed triangles.
+ */
+
+/**
+ * @brief Merges coincident points and rewrites the polygon connectivity to share them.
+ *
+ * Points are hashed on their exact coordinates, or on a grid of the given tolerance,
+ * and split into hash buckets that are deduplicated in parallel with vtkSMPTools.
+ * With a tolerance, points are snapped to grid cells of that size, so two points closer
+ * than the tolerance but on opposite sides of a cell boundary are not merged.
+ *
+ * Cell data is passed through unchanged. Point data is dropped, as STL has none.
+ * Safe to call from any thread.
+ *
+ * @param input Poly data with float points and polygon cells.
+ * @param tolerance Grid size used to merge nearby points, or 0 to merge exact duplicates only.
+ * @return New poly data sharing the input's cell data, or the input itself if it has no points.
+ */
+vtkSmartPointer<vtkPolyData> WeldVertices(vtkPolyData* input, double tolerance = 0.0);
+
+#endif // VERTEX_WELD_H
@@ -0,0 +1,29 @@
+#include "vrbackend.h"
+
+#include <algorithm>
+#include <cmath>
+
+void VRBackend::framePresented() {
+    frameStats.frames++;
+
+    if (!sinceLastFrame.isValid()) {
+        sinceLastFrame.start();
+        return;
+    }
+
+    const double ms = sinceLastFrame.nsecsElapsed() / 1e6;
+    sinceLastFrame.start();
+
+    frameStats.lastFrameMs = ms;
+    frameStats.maxFrameMs = std::max(frameStats.maxFrameMs, ms);
+    totalFrameMs += ms;
+    frameStats.meanFrameMs = totalFrameMs / (frameStats.frames - 1);
+
+    if (ms > 1.5 * frameStats.targetFrameMs)
+        frameStats.droppedFrames += static_cast<quint64>(std::lround(ms / frameStats.targetFrameMs)) - 1;
+}
+
+void VRBackend::setRefreshRate(double hz) {
+    if (hz > 0)
+        frameStats.targetFrameMs = 1000.0 / hz;
+}
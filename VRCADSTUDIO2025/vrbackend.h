@@ -0,0 +1,129 @@
+#ifndef VR_BACKEND_H
+#define VR_BACKEND_H
+
+#include <QString>
+#include <QElapsedTimer>
+
+#include <vtkRenderer.h>
+
+/**
+ * @file
+ * This file contains the interface between VRRenderThread and the device it renders
+ * to, and the frame statistics every backend reports.
+ */
+
+/**
+ * @brief Where the head is and where it looks, in world coordinates.
+ *
+ * Controllers use the same layout, with the focal point along the pointing direction.
+ */
+struct HeadPose {
+    double position[3] = { 0, 0, 1 };    /**< Point between the eyes */
+    double focalPoint[3] = { 0, 0, 0 };  /**< Point looked at */
+    double viewUp[3] = { 0, 1, 0 };      /**< Up direction of the head */
+};
+
+/**
+ * @brief Frame timing collected by a VR backend.
+ */
+struct VRFrameStats {
+    quint64 frames = 0;          /**< Frames presented */
+    quint64 droppedFrames = 0;   /**< Display refreshes that showed a repeated frame */
+    double targetFrameMs = 1000.0 / 90.0;  /**< Display refresh period */
+    double lastFrameMs = 0;      /**< Time between the last two frames */
+    double meanFrameMs = 0;      /**< Mean time between frames */
+    double maxFrameMs = 0;       /**< Longest time between frames */
+    double lastCpuMs = 0;        /**< CPU time the render thread used for the last frame */
+    double meanCpuMs = 0;        /**< Mean CPU time per frame */
+    quint64 idleWaits = 0;       /**< Frames the device did not pace, so the thread slept */
+};
+
+/**
+ * @class VRBackend
+ * @brief A headset, real or simulated, that VRRenderThread renders the scene to.
+ *
+ * The backend is created on the GUI thread but every method is called on the VR
+ * thread, in the order renderer(), start(), then renderFrame() until it returns
+ * false or the thread is asked to stop, then stop(). VTK objects must therefore be
+ * created in renderer() or start(), not in the constructor.
+ */
+class VRBackend {
+public:
+    virtual ~VRBackend() = default;
+
+    /**
+     * @brief Returns a short name for logs.
+     */
+    virtual QString name() const = 0;
+
+    /**
+     * @brief Creates the renderer the scene is built in.
+     *
+     * Called once before start(). The backend keeps ownership.
+     */
+    virtual vtkRenderer* renderer() = 0;
+
+    /**
+     * @brief Opens the device and renders the first frame.
+     * @return false if the device could not be opened.
+     */
+    virtual bool start() = 0;
+
+    /**
+     * @brief Handles pending device events and presents one frame.
+     * @return false once the session has been ended from the device side.
+     */
+    virtual bool renderFrame() = 0;
+
+    /**
+     * @brief Closes the device.
+     */
+    virtual void stop() = 0;
+
+    /**
+     * @brief Returns the head pose the last frame was rendered from.
+     */
+    virtual HeadPose headPose() const = 0;
+
+    /**
+     * @brief Returns the pose of a controller in the last frame.
+     * @param hand 0 for the left controller, 1 for the right.
+     * @param pose Set to the pose if the controller is tracked.
+     * @return false if the controller is not tracked or the backend has none.
+     */
+    virtual bool controllerPose(int hand, HeadPose& pose) const { (void)hand; (void)pose; return false; }
+
+    /**
+     * @brief Returns the time until the display next refreshes.
+     * @return Nanoseconds to the next vsync, or -1 if the device cannot tell.
+     */
+    virtual qint64 nanosecondsToVsync() const { return -1; }
+
+    /**
+     * @brief Returns the timing of the frames presented so far.
+     */
+    const VRFrameStats& stats() const { return frameStats; }
+
+protected:
+    /**
+     * @brief Counts a presented frame, timing it from the previous one.
+     *
+     * Gaps longer than one and a half refresh periods count the refreshes that were
+     * missed as dropped frames.
+     */
+    void framePresented();
+
+    /**
+     * @brief Sets the refresh period frames are measured against.
+     * @param hz Display refresh rate.
+     */
+    void setRefreshRate(double hz);
+
+    VRFrameStats frameStats;     /**< Timing so far */
+
+private:
+    QElapsedTimer sinceLastFrame;  /**< Time since the previous frame */
+    double totalFrameMs = 0;       /**< Sum of the measured frame intervals */
+};
+
+#endif // VR_BACKEND_H
@@ -5,29 +5,47 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <QColor>
+#include <QQueue>
+#include <QHash>
+
+#include "vrbackend.h"
+#include "vrsessionlog.h"
+#include "geometrysnapshot.h"
 
 #include <vtkActor.h>
-#include <vtkOpenVRRenderWindow.h>
-#include <vtkOpenVRRenderWindowInteractor.h>
-#include <vtkOpenVRRenderer.h>
-#include <vtkOpenVRCamera.h>
+#include <vtkRenderer.h>
 #include <vtkActorCollection.h>
 #include <vtkLight.h>  
 #include <vtkSkybox.h> 
+#include <vtkMatrix4x4.h>
+#include <vtkTransform.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
 
 /**
  * @file
  * This file contains the declaration of the VRRenderThread class,
- * which handles rendering of 3D content in VR using VTK's OpenVR module.
+ * which handles rendering of 3D content in VR through a VRBackend.
  */
 
  /**
   * @class VRRenderThread
-  * @brief A thread for managing VR rendering using VTK and OpenVR.
+  * @brief A thread for managing VR rendering using VTK.
   *
-  * This class creates and manages a separate thread for VR rendering. It supports
+  * This class creates and manages a separate thread for VR rendering. The device
+  * is a VRBackend: a SteamVR headset, or a simulated one rendering offscreen when
+  * no headset is available. It supports
   * adding actors, issuing rendering commands (e.g., rotation, lighting), and setting
   * a skybox or background color.
+  *
+  * VTK is not thread safe, so the GUI thread never touches the VR scene directly.
+  * Every edit is pushed onto a mutex-protected queue of SceneUpdate records which
+  * run() drains between frames, so the headset session stays up while the scene
+  * is edited. Frames are paced by the headset's vsync and animation advances by
+  * the time between frames, so it runs at the same speed whatever the frame rate.
   */
 class VRRenderThread : public QThread {
     Q_OBJECT
@@ -42,9 +60,29 @@ public:
         ROTATE_Y,            /**< Rotate the scene along the Y-axis */
         ROTATE_Z,            /**< Rotate the scene along the Z-axis */
         SET_LIGHT_INTENSITY, /**< Adjust the lighting intensity */
-        LOAD_SKYBOX          /**< Load a skybox texture */
+        LOAD_SKYBOX,         /**< Load a skybox texture */
+        ADD_ACTOR,           /**< Add (or replace) a keyed actor */
+        REMOVE_ACTOR,        /**< Remove a keyed actor */
+        SET_TRANSFORM,       /**< Set the local transform of a keyed node */
+        SET_COLOR,           /**< Set the colour of a keyed actor */
+        SET_VISIBILITY,      /**< Show or hide a keyed actor */
+        SET_BACKGROUND,      /**< Set the background colour */
+        SET_GEOMETRY         /**< Show a new geometry snapshot on a keyed actor */
     } Command;
 
+    /**
+     * @brief A single scene edit queued by the GUI thread and applied by run().
+     */
+    struct SceneUpdate {
+        int command = END_RENDER;           /**< Command enum value */
+        quintptr key = 0;                   /**< Identifies the actor the update applies to */
+        quintptr parentKey = 0;             /**< Parent node (SET_TRANSFORM only) */
+        vtkSmartPointer<vtkActor> actor;    /**< New actor (ADD_ACTOR only) */
+        double values[16] = {};             /**< Payload: matrix, colour or scalar value */
+        std::vector<std::string> files;     /**< Cubemap faces (LOAD_SKYBOX only) */
+        GeometrySnapshot::Ptr geometry;     /**< New geometry (SET_GEOMETRY only) */
+    };
+
     /**
      * @brief Constructs the VRRenderThread.
      * @param parent Parent QObject.
@@ -56,12 +94,108 @@ public:
      */
     ~VRRenderThread() override;
 
+    /**
+     * @brief Sets the device to render to. Must be called before start().
+     *
+     * Without a backend the thread reports backendFailed() and exits.
+     * @param backend The backend; the thread takes ownership.
+     * @return false if the thread is already running, in which case the backend is deleted.
+     */
+    bool setBackend(VRBackend* backend);
+
+    /**
+     * @brief Returns the name of the backend in use.
+     */
+    QString backendName() const;
+
+    /**
+     * @brief Returns the frame timing of the session so far. Safe to call from any thread.
+     */
+    VRFrameStats frameStats() const;
+
+    /**
+     * @brief Records the session to a log for replaySession(). Must be called before start().
+     *
+     * Every frame's head and controller poses and timing are written, with every
+     * command the thread applies.
+     * @param fileName Log file to create.
+     */
+    void recordSession(const QString& fileName);
+
+    /**
+     * @brief Replays a recorded session. Must be called before start().
+     *
+     * The scene must be sent the same way as when it was recorded, e.g. the same files
+     * loaded in the same order. The backend should be a SimulatedHMDBackend following
+     * the log's head poses. Recorded commands are reapplied after the frame they
+     * followed, except adding and removing actors or changing their geometry, since
+     * the geometry comes from the scene sent for the replay. Animation follows the recorded frame times, so the
+     * scene moves the same way whatever the replay frame rate.
+     * @param log The session; must outlive the thread.
+     */
+    void replaySession(const VRSessionLog* log);
+
+    /**
+     * @brief Returns the timing and pose of every frame of a replay. Call after wait().
+     */
+    const std::vector<VRSessionFrame>& replayFrames() const { return replayed; }
+
     /**
      * @brief Adds an actor to the VR scene (before the thread starts).
      * @param actor The actor to add.
      */
     void addActorOffline(vtkActor* actor);
 
+    /**
+     * @brief Queues an actor for the VR scene, replacing any actor with the same key.
+     *
+     * Safe to call before or while the thread is running.
+     * @param key Caller-chosen identifier used by later updates.
+     * @param actor The actor to add. It must not be shared with another renderer.
+     */
+    void addActor(quintptr key, vtkActor* actor);
+
+    /**
+     * @brief Queues removal of a keyed actor.
+     * @param key Identifier passed to addActor().
+     */
+    void removeActor(quintptr key);
+
+    /**
+     * @brief Queues a new local transform for a node of the VR transform hierarchy.
+     *
+     * Every keyed actor follows the node with the same key, and every node follows
+     * its parent, so moving an assembly only needs its own node to be sent.
+     * @param key Identifier of the node, the same as the actor's key if it has one.
+     * @param parentKey Identifier of the parent node.
+     * @param matrix The transform relative to the parent; it is copied.
+     */
+    void setNodeTransform(quintptr key, quintptr parentKey, vtkMatrix4x4* matrix);
+
+    /**
+     * @brief Queues a colour change for a keyed actor.
+     * @param key Identifier passed to addActor().
+     * @param color The new colour.
+     */
+    void setActorColor(quintptr key, const QColor& color);
+
+    /**
+     * @brief Queues a visibility change for a keyed actor.
+     * @param key Identifier passed to addActor().
+     * @param visible The new visibility.
+     */
+    void setActorVisibility(quintptr key, bool visible);
+
+    /**
+     * @brief Queues new geometry for a keyed actor, e.g. after a filter change.
+     *
+     * The actor keeps its transform, colour and mapper; only the mapper's input is
+     * replaced by a view of the snapshot, so nothing is copied.
+     * @param key Identifier passed to addActor().
+     * @param geometry The part's published geometry.
+     */
+    void setActorGeometry(quintptr key, const GeometrySnapshot::Ptr& geometry);
+
     /**
      * @brief Issues a command to the VR renderer.
      * @param cmd The command type.
@@ -83,6 +217,12 @@ public slots:
      */
     void setVRBackgroundColor(const QColor& color);
 
+signals:
+    /**
+     * @brief Emitted from the VR thread when the backend could not start.
+     * @param backend Name of the backend.
+     */
+    void backendFailed(const QString& backend);
 
 protected:
     /**
@@ -91,23 +231,91 @@ protected:
     void run() override;
 
 private:
-    vtkSmartPointer<vtkOpenVRRenderWindow> window; /**< VR render window */
-    vtkSmartPointer<vtkOpenVRRenderWindowInteractor> interactor; /**< VR interactor */
-    vtkSmartPointer<vtkOpenVRRenderer> renderer; /**< VR renderer */
-    vtkSmartPointer<vtkOpenVRCamera> camera; /**< VR camera */
+    /**
+     * @brief Queues an update for the render loop.
+     * @param update The update to append.
+     */
+    void enqueue(const SceneUpdate& update);
+
+    /**
+     * @brief Applies every queued update to the VR scene. Runs on the VR thread only.
+     */
+    void applyPendingUpdates();
+
+    /**
+     * @brief Applies one update to the VR scene.
+     * @param update The update to apply.
+     */
+    void applyUpdate(const SceneUpdate& update);
+
+    /**
+     * @brief Writes an applied update to the session log.
+     * @param update The update that was applied.
+     */
+    void recordCommand(const SceneUpdate& update);
+
+    /**
+     * @brief Applies the replayed commands recorded after a frame.
+     * @param frame Frame number, 0 for commands applied before the first frame.
+     */
+    void applyRecordedCommands(quint32 frame);
+
+    /**
+     * @brief Logs or collects the frame just presented.
+     * @param timeNs Time of the frame since the render loop started.
+     * @param renderMs Time spent in the backend's renderFrame().
+     */
+    void recordFrame(qint64 timeNs, float renderMs);
+
+    /**
+     * @brief Applies the initial VR placement transform to a new actor.
+     * @param actor The actor to position.
+     */
+    void placeActor(vtkActor* actor);
+
+    /**
+     * @brief A node of the VR transform hierarchy.
+     */
+    struct TransformNode {
+        vtkSmartPointer<vtkTransform> local; /**< Transform relative to the parent */
+        vtkSmartPointer<vtkTransform> world; /**< Parent's world transform followed by local */
+    };
+
+    /**
+     * @brief Returns the node for a key, creating it under the scene transform if needed.
+     * @param key Identifier of the node.
+     */
+    TransformNode& node(quintptr key);
+
+    std::unique_ptr<VRBackend> backend; /**< Device rendered to */
+    vtkRenderer* renderer = nullptr; /**< Scene renderer, owned by the backend */
+    mutable QMutex statsMutex; /**< Guards stats */
+    VRFrameStats stats; /**< Copy of the backend's frame timing for other threads */
 
     QMutex mutex; /**< Mutex for thread-safe access */
     QWaitCondition condition; /**< Condition for command synchronization */
+    QQueue<SceneUpdate> pendingUpdates; /**< Updates waiting for the render loop, guarded by mutex */
+    QHash<quintptr, vtkSmartPointer<vtkActor>> keyedActors; /**< Actors added through addActor() */
+    QHash<quintptr, TransformNode> nodes; /**< Transform hierarchy mirrored from the model tree */
+    vtkSmartPointer<vtkTransform> sceneTransform; /**< Spin applied to the whole scene */
 
     vtkSmartPointer<vtkActorCollection> actors; /**< Actors to render */
 
-    std::chrono::time_point<std::chrono::steady_clock> t_last; /**< Last update time */
+    std::chrono::time_point<std::chrono::steady_clock> t_last; /**< Time of the last animation step */
+
+    QString recordFile; /**< Session log to write, empty if not recording */
+    VRSessionRecorder recorder; /**< Writer of the session log */
+    const VRSessionLog* replay = nullptr; /**< Session being replayed */
+    size_t nextReplayCommand = 0; /**< First replay command not applied yet */
+    std::vector<VRSessionFrame> replayed; /**< Frames presented during a replay */
+    VRSessionIds sessionIds; /**< Node keys numbered for recording and replay */
+    quint32 sessionFrame = 0; /**< Frames presented so far */
 
     bool endRender; /**< Flag to end rendering loop */
 
-    double rotateX; /**< Rotation speed on X-axis */
-    double rotateY; /**< Rotation speed on Y-axis */
-    double rotateZ; /**< Rotation speed on Z-axis */
+    double rotateX; /**< Rotation speed on X-axis, degrees per 20 ms */
+    double rotateY; /**< Rotation speed on Y-axis, degrees per 20 ms */
+    double rotateZ; /**< Rotation speed on Z-axis, degrees per 20 ms */
 
     vtkSmartPointer<vtkSkybox> skybox; /**< Skybox for VR background */
     vtkSmartPointer<vtkLight> light; /**< Lighting in the scene */
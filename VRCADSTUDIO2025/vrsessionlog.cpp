@@ -0,0 +1,181 @@
+#include "vrsessionlog.h"
+
+namespace {
+    const quint32 Magic = 0x5652434C;   // "VRCL"
+    const quint16 Version = 1;
+
+    /* Record types. Each record starts with one of these bytes */
+    const quint8 DisplayRecord = 0;
+    const quint8 FrameRecord = 1;
+    const quint8 CommandRecord = 2;
+
+    void writePose(QDataStream& out, const HeadPose& pose) {
+        for (int i = 0; i < 3; ++i)
+            out << pose.position[i];
+        for (int i = 0; i < 3; ++i)
+            out << pose.focalPoint[i];
+        for (int i = 0; i < 3; ++i)
+            out << pose.viewUp[i];
+    }
+
+    void readPose(QDataStream& in, HeadPose& pose) {
+        float value;
+        for (int i = 0; i < 3; ++i) { in >> value; pose.position[i] = value; }
+        for (int i = 0; i < 3; ++i) { in >> value; pose.focalPoint[i] = value; }
+        for (int i = 0; i < 3; ++i) { in >> value; pose.viewUp[i] = value; }
+    }
+}
+
+quint32 VRSessionIds::id(quintptr key) {
+    if (key == 0)
+        return 0;
+    auto it = ids.find(key);
+    if (it == ids.end()) {
+        keys.push_back(key);
+        it = ids.insert(key, static_cast<quint32>(keys.size()));
+    }
+    return it.value();
+}
+
+quintptr VRSessionIds::key(quint32 id) const {
+    if (id == 0 || id > keys.size())
+        return 0;
+    return keys[id - 1];
+}
+
+bool VRSessionRecorder::open(const QString& fileName) {
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    // Single precision applies to doubles as well, so poses are written as floats
+    stream.setDevice(&file);
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    stream << Magic << Version;
+    return true;
+}
+
+void VRSessionRecorder::writeDisplayRate(double hz) {
+    stream << DisplayRecord << hz;
+}
+
+void VRSessionRecorder::writeFrame(const VRSessionFrame& frame) {
+    stream << FrameRecord << frame.frame << frame.timeNs << frame.intervalMs << frame.renderMs;
+    writePose(stream, frame.head);
+
+    const quint8 tracked = (frame.controllerTracked[0] ? 1 : 0) | (frame.controllerTracked[1] ? 2 : 0);
+    stream << tracked;
+    for (int hand = 0; hand < 2; ++hand) {
+        if (frame.controllerTracked[hand])
+            writePose(stream, frame.controllers[hand]);
+    }
+}
+
+void VRSessionRecorder::writeCommand(const VRSessionCommand& command) {
+    stream << CommandRecord << command.frame << command.command << command.node << command.parent
+           << static_cast<quint8>(command.values.size());
+    for (float value : command.values)
+        stream << value;
+
+    stream << static_cast<quint8>(command.files.size());
+    for (const QString& face : command.files)
+        stream << face;
+}
+
+void VRSessionRecorder::close() {
+    stream.setDevice(nullptr);
+    file.close();
+}
+
+/**
+ * @brief Reads the records in order. A log cut short by a crash keeps every record
+ * that was written in full.
+ */
+bool VRSessionLog::load(const QString& fileName, QString* error) {
+    auto fail = [error](const QString& reason) {
+        if (error)
+            *error = reason;
+        return false;
+    };
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return fail("Could not open " + fileName);
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != Magic)
+        return fail(fileName + " is not a VR session log");
+    if (version != Version)
+        return fail(QString("%1 has unsupported version %2").arg(fileName).arg(version));
+
+    frames.clear();
+    commands.clear();
+
+    while (!in.atEnd()) {
+        quint8 type = 0;
+        in >> type;
+
+        if (type == DisplayRecord) {
+            in >> displayRate;
+        }
+        else if (type == FrameRecord) {
+            VRSessionFrame frame;
+            in >> frame.frame >> frame.timeNs >> frame.intervalMs >> frame.renderMs;
+            readPose(in, frame.head);
+
+            quint8 tracked = 0;
+            in >> tracked;
+            for (int hand = 0; hand < 2; ++hand) {
+                frame.controllerTracked[hand] = (tracked >> hand) & 1;
+                if (frame.controllerTracked[hand])
+                    readPose(in, frame.controllers[hand]);
+            }
+            if (in.status() == QDataStream::Ok)
+                frames.push_back(frame);
+        }
+        else if (type == CommandRecord) {
+            VRSessionCommand command;
+            quint8 count = 0;
+            in >> command.frame >> command.command >> command.node >> command.parent >> count;
+            command.values.resize(count);
+            for (float& value : command.values)
+                in >> value;
+
+            in >> count;
+            for (int i = 0; i < count; ++i) {
+                QString face;
+                in >> face;
+                command.files << face;
+            }
+            if (in.status() == QDataStream::Ok)
+                commands.push_back(command);
+        }
+        else {
+            return fail(QString("%1 is corrupt at byte %2").arg(fileName).arg(file.pos()));
+        }
+
+        if (in.status() != QDataStream::Ok)
+            break;
+    }
+
+    if (frames.empty())
+        return fail(fileName + " contains no frames");
+    return true;
+}
+
+std::vector<HeadPose> VRSessionLog::headPoses() const {
+    std::vector<HeadPose> poses;
+    poses.reserve(frames.size());
+    for (const VRSessionFrame& frame : frames)
+        poses.push_back(frame.head);
+    return poses;
+}
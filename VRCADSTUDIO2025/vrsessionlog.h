@@ -0,0 +1,131 @@
+#ifndef VR_SESSION_LOG_H
+#define VR_SESSION_LOG_H
+
+#include "vrbackend.h"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QFile>
+#include <QDataStream>
+
+#include <vector>
+
+/**
+ * @file
+ * This file contains the binary log of a VR session: the head and controller poses of
+ * every frame and the scene commands the VR thread applied, so a session can be
+ * replayed against the same scene and its frame times compared.
+ */
+
+/**
+ * @brief One presented frame of a recorded session.
+ */
+struct VRSessionFrame {
+    quint32 frame = 0;           /**< Frame number, counting from 1 */
+    qint64 timeNs = 0;           /**< Time since the session started */
+    float intervalMs = 0;        /**< Time since the previous frame */
+    float renderMs = 0;          /**< Time spent rendering and submitting the frame */
+    HeadPose head;               /**< Head pose the frame was rendered from */
+    bool controllerTracked[2] = { false, false };  /**< Left and right controller seen */
+    HeadPose controllers[2];     /**< Left and right controller poses */
+};
+
+/**
+ * @brief A scene command applied by the VR thread, with its node keys replaced by
+ * session ids so it can be matched to the same part in another run.
+ */
+struct VRSessionCommand {
+    quint32 frame = 0;           /**< Applied after this frame; 0 is before the first */
+    quint8 command = 0;          /**< VRRenderThread command */
+    quint32 node = 0;            /**< Session id of the node, 0 for none */
+    quint32 parent = 0;          /**< Session id of the parent node */
+    QVector<float> values;       /**< Matrix, colour or scalar payload */
+    QStringList files;           /**< Cubemap faces */
+};
+
+/**
+ * @class VRSessionIds
+ * @brief Numbers node keys in the order they are first seen.
+ *
+ * Keys are pointers that change between runs, but a scene sent the same way gets
+ * the same ids, which is what lets a replay find the parts a command applied to.
+ */
+class VRSessionIds {
+public:
+    /**
+     * @brief Returns the id of a key, numbering it if it is new. Key 0 is id 0.
+     */
+    quint32 id(quintptr key);
+
+    /**
+     * @brief Returns the key numbered id, or 0 if no key has that id yet.
+     */
+    quintptr key(quint32 id) const;
+
+private:
+    QHash<quintptr, quint32> ids;    /**< Key to id */
+    std::vector<quintptr> keys;      /**< Id - 1 to key */
+};
+
+/**
+ * @class VRSessionRecorder
+ * @brief Streams a session log to disk as it is recorded.
+ *
+ * Poses and payloads are stored as 32-bit floats, which keeps a frame to 58 bytes
+ * plus 36 per tracked controller, about 8 kB per second at 90 Hz.
+ */
+class VRSessionRecorder {
+public:
+    /**
+     * @brief Creates the log file and writes its header.
+     * @return false if the file could not be created.
+     */
+    bool open(const QString& fileName);
+
+    /**
+     * @brief Records the display refresh rate the session ran at.
+     */
+    void writeDisplayRate(double hz);
+
+    void writeFrame(const VRSessionFrame& frame);
+    void writeCommand(const VRSessionCommand& command);
+
+    /**
+     * @brief Flushes and closes the file.
+     */
+    void close();
+
+    bool isOpen() const { return file.isOpen(); }
+
+private:
+    QFile file;             /**< Log file */
+    QDataStream stream;     /**< Writer on file */
+};
+
+/**
+ * @class VRSessionLog
+ * @brief A recorded session read back for replay.
+ */
+class VRSessionLog {
+public:
+    /**
+     * @brief Reads a log written by VRSessionRecorder.
+     * @param fileName Log to read.
+     * @param error Set to the reason if the log could not be read.
+     * @return false if the file is missing, not a session log or truncated.
+     */
+    bool load(const QString& fileName, QString* error = nullptr);
+
+    /**
+     * @brief Returns the head pose of every frame, in order.
+     */
+    std::vector<HeadPose> headPoses() const;
+
+    double displayRate = 90.0;                  /**< Refresh rate of the recorded session */
+    std::vector<VRSessionFrame> frames;         /**< Frames in order */
+    std::vector<VRSessionCommand> commands;     /**< Commands in the order they were applied */
+};
+
+#endif // VR_SESSION_LOG_H